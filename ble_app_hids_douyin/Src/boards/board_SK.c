@@ -44,7 +44,9 @@
 #include "app_log.h"
 #include "app_assert.h"
 #include "app_io.h"
+#include "app_timer.h"
 #include "board_SK.h"
+#include "user_ram.h"
 #if (APP_LOG_PORT == 1)
 #include "SEGGER_RTT.h"
 #endif
@@ -53,13 +55,21 @@
     BOARD_SK DEFINE .
 */
 #define UART_TX_BUFF_SIZE                  0x400
+#define BSP_KEY_NUM                        2
+#define BSP_KEY_DEBOUNCE_MS                20        /**< Edges of a zero-wait key are ignored this long after its last reported edge. */
 
 /*
  * LOCAL VARIABLE DEFINITIONS
  *****************************************************************************************
  */
-static uint8_t s_uart_tx_buffer[UART_TX_BUFF_SIZE];
+USER_RAM_REINIT static uint8_t s_uart_tx_buffer[UART_TX_BUFF_SIZE];
 static app_uart_params_t uart_param;
+static bool              s_uart_ready;
+static app_timer_id_t    s_key_debounce_timer_id[BSP_KEY_NUM];  /**< One debounce window per key, indexed by key ID. */
+static const uint8_t     s_key_ids[BSP_KEY_NUM] = {BSP_KEY_UP_ID, BSP_KEY_OK_ID};
+static volatile uint8_t  s_key_zero_wait_mask;     /**< Keys handled by the zero-wait path. */
+static volatile uint8_t  s_key_down_mask;          /**< Last reported state of zero-wait keys. */
+static volatile uint8_t  s_key_debounce_mask;      /**< Zero-wait keys within their debounce window. */
 
 void bsp_uart_send(uint8_t *p_data, uint16_t length)
 {
@@ -104,6 +114,16 @@ void bsp_uart_init(void)
     uart_param.dma_cfg.rx_dma_channel = DMA_Channel3;
 
     app_uart_init(&uart_param, app_uart_evt_handler, &uart_buffer);
+    s_uart_ready = true;
+}
+
+void bsp_uart_clock_update(void)
+{
+    if (s_uart_ready)
+    {
+        app_uart_deinit(APP_UART_ID);
+        bsp_uart_init();
+    }
 }
 
 #if (APP_LOG_PORT == 1)
@@ -163,23 +183,158 @@ __WEAK void app_key_evt_handler(uint8_t key_id, app_key_click_type_t key_click_t
     UNUSED(key_click_type);
 }
 
+__WEAK bool app_key_zero_wait_check(uint8_t key_id)
+{
+    UNUSED(key_id);
+    return false;
+}
+
+__WEAK void app_key_down_handler(uint8_t key_id)
+{
+    UNUSED(key_id);
+}
+
+__WEAK void app_key_up_handler(uint8_t key_id)
+{
+    UNUSED(key_id);
+}
+
+/**
+ *****************************************************************************************
+ * @brief Report a zero-wait key whose level differs from its last reported state, and
+ *        open its debounce window.
+ *****************************************************************************************
+ */
+static void bsp_key_level_update(uint8_t key_id)
+{
+    bool pressed = bsp_key_is_pressed(key_id);
+    bool changed;
+
+    // Called from the GPIO interrupt and the timer callback, the masks are updated in one go.
+    GLOBAL_EXCEPTION_DISABLE();
+    changed = (pressed != !!(s_key_down_mask & (1 << key_id)));
+    if (changed)
+    {
+        s_key_down_mask     ^= (1 << key_id);
+        s_key_debounce_mask |= (1 << key_id);
+    }
+    GLOBAL_EXCEPTION_ENABLE();
+
+    if (!changed)
+    {
+        return;
+    }
+    if (pressed)
+    {
+        app_key_down_handler(key_id);
+    }
+    else
+    {
+        app_key_up_handler(key_id);
+    }
+    app_timer_start(s_key_debounce_timer_id[key_id], BSP_KEY_DEBOUNCE_MS, (void *)&s_key_ids[key_id]);
+}
+
+static void bsp_key_debounce_timeout_handler(void *p_arg)
+{
+    uint8_t key_id = *(const uint8_t *)p_arg;
+
+    GLOBAL_EXCEPTION_DISABLE();
+    s_key_debounce_mask &= ~(1 << key_id);
+    GLOBAL_EXCEPTION_ENABLE();
+    // Catch a release or press that happened inside the window.
+    bsp_key_level_update(key_id);
+}
+
+/**
+ *****************************************************************************************
+ * @brief Edge interrupt of a zero-wait key: the first edge is reported at once (leading
+ *        edge debounce), bounces within BSP_KEY_DEBOUNCE_MS are ignored.
+ *****************************************************************************************
+ */
+static void bsp_key_edge_handler(app_io_evt_t *p_evt)
+{
+    uint8_t key_id = (p_evt->pin == APP_KEY_UP_PIN) ? BSP_KEY_UP_ID : BSP_KEY_OK_ID;
+
+    if (s_key_debounce_mask & (1 << key_id))
+    {
+        return;
+    }
+    bsp_key_level_update(key_id);
+}
+
 void bsp_key_init(void)
 {
-    app_key_gpio_t app_key_inst[2];
+    app_key_gpio_t     app_key_inst[BSP_KEY_NUM];
+    app_gpiote_param_t gpiote_param[BSP_KEY_NUM];
+    uint8_t            app_key_num = 0;
+    uint8_t            gpiote_num  = 0;
+    const struct
+    {
+        app_io_type_t type;
+        uint32_t      pin;
+        uint8_t       key_id;
+    } keys[BSP_KEY_NUM] =
+    {
+        {APP_KEY_UP_IO_TYPE, APP_KEY_UP_PIN, BSP_KEY_UP_ID},
+        {APP_KEY_OK_IO_TYPE, APP_KEY_OK_PIN, BSP_KEY_OK_ID},
+    };
 
-    app_key_inst[0].gpio_type    = APP_KEY_UP_IO_TYPE;
-    app_key_inst[0].gpio_pin     = APP_KEY_UP_PIN;
-    app_key_inst[0].trigger_mode = APP_KEY_TRIGGER_MODE;
-    app_key_inst[0].pull         = APP_KEY_PULL_MODE;
-    app_key_inst[0].key_id       = BSP_KEY_UP_ID;
+    for (uint8_t i = 0; i < BSP_KEY_NUM; i++)
+    {
+        if (app_key_zero_wait_check(keys[i].key_id))
+        {
+            // Both edges straight from the GPIO, app_key would hold single clicks for its double click window.
+            gpiote_param[gpiote_num].type        = keys[i].type;
+            gpiote_param[gpiote_num].pin         = keys[i].pin;
+            gpiote_param[gpiote_num].mode        = APP_IO_MODE_IT_BOTH_EDGE;
+            gpiote_param[gpiote_num].pull        = APP_KEY_PULL_MODE;
+            gpiote_param[gpiote_num].handle_mode = APP_IO_ENABLE_WAKEUP;
+            gpiote_param[gpiote_num].io_evt_cb   = bsp_key_edge_handler;
+            gpiote_num++;
+            s_key_zero_wait_mask |= (1 << keys[i].key_id);
+        }
+        else
+        {
+            app_key_inst[app_key_num].gpio_type    = keys[i].type;
+            app_key_inst[app_key_num].gpio_pin     = keys[i].pin;
+            app_key_inst[app_key_num].trigger_mode = APP_KEY_TRIGGER_MODE;
+            app_key_inst[app_key_num].pull         = APP_KEY_PULL_MODE;
+            app_key_inst[app_key_num].key_id       = keys[i].key_id;
+            app_key_num++;
+        }
+    }
 
-    app_key_inst[1].gpio_type    = APP_KEY_OK_IO_TYPE;
-    app_key_inst[1].gpio_pin     = APP_KEY_OK_PIN;
-    app_key_inst[1].trigger_mode = APP_KEY_TRIGGER_MODE;
-    app_key_inst[1].pull         = APP_KEY_PULL_MODE;
-    app_key_inst[1].key_id       = BSP_KEY_OK_ID;
+    if (app_key_num)
+    {
+        app_key_init(app_key_inst, app_key_num, app_key_evt_handler);
+    }
+    if (gpiote_num)
+    {
+        for (uint8_t i = 0; i < BSP_KEY_NUM; i++)
+        {
+            if (s_key_zero_wait_mask & (1 << keys[i].key_id))
+            {
+                app_timer_create(&s_key_debounce_timer_id[keys[i].key_id], ATIMER_ONE_SHOT, bsp_key_debounce_timeout_handler);
+            }
+        }
+        app_gpiote_init(gpiote_param, gpiote_num);
+    }
+}
+
+bool bsp_key_is_pressed(uint8_t key_id)
+{
+    switch (key_id)
+    {
+        case BSP_KEY_UP_ID:
+            return APP_IO_PIN_RESET == app_io_read_pin(APP_KEY_UP_IO_TYPE, APP_KEY_UP_PIN);
 
-    app_key_init(app_key_inst, 2, app_key_evt_handler);
+        case BSP_KEY_OK_ID:
+            return APP_IO_PIN_RESET == app_io_read_pin(APP_KEY_OK_IO_TYPE, APP_KEY_OK_PIN);
+
+        default:
+            return false;
+    }
 }
 
 void bsp_led_init(void)
@@ -225,6 +225,17 @@ typedef enum
  */
 void bsp_key_init(void);
 
+/**
+ *****************************************************************************************
+ * @brief Read the current level of a key, keys are active low.
+ *
+ * @param[in] key_id: BSP_KEY_UP_ID or BSP_KEY_OK_ID.
+ *
+ * @return true if the key is held down.
+ *****************************************************************************************
+ */
+bool bsp_key_is_pressed(uint8_t key_id);
+
 /**
  *****************************************************************************************
  * @brief App key event handler
@@ -232,6 +243,28 @@ void bsp_key_init(void);
  */
 void app_key_evt_handler(uint8_t key_id, app_key_click_type_t key_click_type);
 
+/**
+ *****************************************************************************************
+ * @brief Check whether a key bypasses app_key and reports raw key-down/up edges.
+ *        Called once from bsp_key_init(), the weak default keeps every key on app_key.
+ *****************************************************************************************
+ */
+bool app_key_zero_wait_check(uint8_t key_id);
+
+/**
+ *****************************************************************************************
+ * @brief Zero-wait key pressed, called from interrupt context on the leading edge.
+ *****************************************************************************************
+ */
+void app_key_down_handler(uint8_t key_id);
+
+/**
+ *****************************************************************************************
+ * @brief Zero-wait key released, called from interrupt context.
+ *****************************************************************************************
+ */
+void app_key_up_handler(uint8_t key_id);
+
 /**
  *****************************************************************************************
  * @brief Initialize app uart.
@@ -253,6 +286,14 @@ void bsp_uart_send(uint8_t *p_data, uint16_t length);
  */
 void bsp_uart_flush(void);
 
+/**
+ *****************************************************************************************
+ * @brief Re-init the UART after a system clock change, its baud rate divisor follows the
+ *        clock. Bytes still in the transmit FIFO are dropped.
+ *****************************************************************************************
+ */
+void bsp_uart_clock_update(void);
+
 /**
  *****************************************************************************************
  * @brief App uart event handler.
@@ -184,7 +184,7 @@
 // <0=> Not Delay
 // <1=> Delay 1s
 #ifndef BOOT_LONG_TIME
-#define BOOT_LONG_TIME                   1
+#define BOOT_LONG_TIME                   0
 #endif
 
 // <o> In xip mode, check image during cold boot startup
@@ -43,6 +43,8 @@
 #include "ble_prf_types.h"
 #include "ble_prf_utils.h"
 #include "utility.h"
+#include "user_trace.h"
+#include "user_perf.h"
 
 /*
  * DEFINES
@@ -109,6 +111,11 @@ enum hids_attr_idx_tag
     HIDS_IDX_FEATURE_REPORT_VAL,       
     HIDS_IDX_FEATURE_REPORT_REF,      
 
+    //Feature Report2 characteristic
+    HIDS_IDX_FEATURE2_REPORT_CHAR,
+    HIDS_IDX_FEATURE2_REPORT_VAL,
+    HIDS_IDX_FEATURE2_REPORT_REF,
+
     //Report Map characteristic
     HIDS_IDX_REPORT_MAP_CHAR,           
     HIDS_IDX_REPORT_MAP_VAL,  
@@ -138,13 +145,13 @@ struct hids_env_t
 {
     hids_init_t               hids_init;                                                   /**< HID Service Init Value. */                       
     uint16_t                  start_hdl;                                                   /**< HID Service start handle. */
-    uint32_t                  char_mask;                                                /**< Mask of Supported characteristics*/ 
+    uint64_t                  char_mask;                                                   /**< Mask of Supported characteristics*/ 
     uint16_t                  input_cccd[IN_REPORT_MAX_COUNT][HIDS_CONNECTION_MAX];        /**< Input report characteristics cccd value*/ 
     uint16_t                  mouse_input_cccd[HIDS_CONNECTION_MAX];                       /**< Boot mouse input report characteristics cccd value*/ 
     uint8_t                   protocol_mode;                                               /**< Protocol mode. */
     uint8_t                   ctrl_pt;                                                     /**< HID Control Point. */
     uint8_t                   input_report_val[IN_REPORT_MAX_COUNT][HIDS_REPORT_MAX_SIZE]; /**< Input report characteristics value*/ 
-    uint8_t                   feature_report_val[HIDS_REPORT_MAX_SIZE]; 
+    uint8_t                   feature_report_val[HIDS_FEATURE_REPORT_MAX_COUNT][HIDS_REPORT_MAX_SIZE]; /**< Feature report characteristics value*/ 
     uint8_t                   mouse_input_report_val[HIDS_BOOT_MOUSE_IN_REPORT_MAX_SIZE];  /**< Boot mouse input report characteristics value*/ 
     ble_gatts_create_db_t     hids_gatts_db;                                               /**< Hid Service attributs database. */
 };
@@ -223,6 +230,16 @@ static const ble_gatts_attm_desc_t hids_attr_tab[HIDS_IDX_NB] =
     //Feature Report Characteristic - Descriptor: Report Reference
     [HIDS_IDX_FEATURE_REPORT_REF]  = {BLE_ATT_DESC_REPORT_REF, BLE_GATTS_READ_PERM(BLE_GATTS_UNAUTH),
                                       BLE_GATTS_ATT_VAL_LOC_USER, sizeof(hids_report_ref_t)},
+    // Added after the first release, no Service Changed is sent: hosts bonded with an older
+    // firmware keep stale handles and must remove the bond (see README).
+    //Feature Report2 Characteristic - Declaration
+    [HIDS_IDX_FEATURE2_REPORT_CHAR] = {BLE_ATT_DECL_CHARACTERISTIC, BLE_GATTS_READ_PERM_UNSEC, 0, 0},
+    //Feature Report2 Characteristic - Value
+    [HIDS_IDX_FEATURE2_REPORT_VAL]  = {BLE_ATT_CHAR_REPORT, BLE_GATTS_READ_PERM(BLE_GATTS_UNAUTH) | BLE_GATTS_WRITE_REQ_PERM(BLE_GATTS_UNAUTH),
+                                       BLE_GATTS_ATT_VAL_LOC_USER, HIDS_REPORT_MAX_SIZE},
+    //Feature Report2 Characteristic - Descriptor: Report Reference
+    [HIDS_IDX_FEATURE2_REPORT_REF]  = {BLE_ATT_DESC_REPORT_REF, BLE_GATTS_READ_PERM(BLE_GATTS_UNAUTH),
+                                       BLE_GATTS_ATT_VAL_LOC_USER, sizeof(hids_report_ref_t)},
                                       
     //Report Map Characteristic - Declaration
     [HIDS_IDX_REPORT_MAP_CHAR] = {BLE_ATT_DECL_CHARACTERISTIC, BLE_GATTS_READ_PERM_UNSEC, 0, 0},
@@ -355,13 +372,23 @@ static void hids_read_att_evt_handler(uint8_t conn_idx, const ble_gatts_evt_read
             break;
 /*----------------------------------------------------------------------------------*/                   
         case HIDS_IDX_FEATURE_REPORT_VAL:
-            cfm.length = s_hids_env.hids_init.count_max_feat_report.value_len;
-            cfm.value  = (uint8_t *)(&s_hids_env.hids_init.count_max_feat);
+            cfm.length = s_hids_env.hids_init.feature_report_array[0].value_len;
+            cfm.value  = (uint8_t *)(&s_hids_env.feature_report_val[0]);
             break;
         
          case HIDS_IDX_FEATURE_REPORT_REF:
             cfm.length = sizeof(hids_report_ref_t);
-            cfm.value  = (uint8_t *)(&s_hids_env.hids_init.count_max_feat_report.ref);
+            cfm.value  = (uint8_t *)(&s_hids_env.hids_init.feature_report_array[0].ref);
+            break;
+/*----------------------------------------------------------------------------------*/
+        case HIDS_IDX_FEATURE2_REPORT_VAL:
+            cfm.length = s_hids_env.hids_init.feature_report_array[1].value_len;
+            cfm.value  = (uint8_t *)(&s_hids_env.feature_report_val[1]);
+            break;
+
+        case HIDS_IDX_FEATURE2_REPORT_REF:
+            cfm.length = sizeof(hids_report_ref_t);
+            cfm.value  = (uint8_t *)(&s_hids_env.hids_init.feature_report_array[1].ref);
             break;
 /*----------------------------------------------------------------------------------*/          
         case HIDS_IDX_REPORT_MAP_VAL:
@@ -599,13 +626,22 @@ static void hids_write_att_evt_handler(uint8_t conn_idx, const ble_gatts_evt_wri
             
             
         case HIDS_IDX_FEATURE_REPORT_VAL:  
-            if((p_param->offset + p_param->length) <= s_hids_env.hids_init.count_max_feat_report.value_len)
+            if((p_param->offset + p_param->length) <= s_hids_env.hids_init.feature_report_array[0].value_len)
             {
-                memcpy(&s_hids_env.feature_report_val[p_param->offset], p_param->value, p_param->length);
+                memcpy(&s_hids_env.feature_report_val[0][p_param->offset], p_param->value, p_param->length);
                 evt.evt_type = HIDS_EVT_REP_CHAR_WRITE;
                 evt.report_type = HIDS_REPORT_TYPE_FEATURE;
             }
             break;
+
+        case HIDS_IDX_FEATURE2_REPORT_VAL:
+            if((p_param->offset + p_param->length) <= s_hids_env.hids_init.feature_report_array[1].value_len)
+            {
+                memcpy(&s_hids_env.feature_report_val[1][p_param->offset], p_param->value, p_param->length);
+                evt.evt_type = HIDS_EVT_REP_CHAR_WRITE;
+                evt.report_type = HIDS_REPORT_TYPE_FEATURE2;
+            }
+            break;
             
         case HIDS_IDX_BOOT_MS_IN_RPT_VAL:
             if((p_param->offset + p_param->length) <= HIDS_BOOT_MOUSE_IN_REPORT_MAX_SIZE)
@@ -681,7 +717,7 @@ static void hids_cccd_set_evt_handler(uint8_t conn_idx, uint16_t handle, uint16_
  * @return BLE_SDK_SUCCESS on success, otherwise an error code.
  *****************************************************************************************
  */
-static sdk_err_t hids_in_rep_notify(uint8_t conn_idx, uint8_t char_idx, uint8_t *p_data, uint16_t length)
+USER_RAM_CODE static sdk_err_t hids_in_rep_notify(uint8_t conn_idx, uint8_t char_idx, uint8_t *p_data, uint16_t length)
 {
     sdk_err_t   error_code;
     ble_gatts_noti_ind_t hids_noti;
@@ -704,6 +740,7 @@ static void hids_ble_evt_handler(const ble_evt_t *p_evt)
         return;
     }
 
+    USER_PROFILE_START(start);
     switch (p_evt->evt_id)
     {
         case BLE_GATTS_EVT_READ_REQUEST:
@@ -726,6 +763,7 @@ static void hids_ble_evt_handler(const ble_evt_t *p_evt)
 //            hids_disconnect_evt_handler(p_evt->evt.gapc_evt.index, p_evt->evt.gapc_evt.params.disconnected.reason);
 //            break;
     }
+    USER_PROFILE_STOP(PROFILE_SITE_HIDS_BLE_EVT, start);
 }
 
 /*
@@ -738,8 +776,19 @@ sdk_err_t hids_service_init(hids_init_t *p_hids_init)
     {
         return SDK_ERR_POINTER_NULL;
     }
+    if (p_hids_init->feature_report_count > HIDS_FEATURE_REPORT_MAX_COUNT)
+    {
+        return SDK_ERR_INVALID_PARAM;
+    }
     memcpy(&s_hids_env.hids_init, p_hids_init, sizeof(hids_init_t));
-    s_hids_env.char_mask = 0xffffffff;
+    memcpy(s_hids_env.feature_report_val, p_hids_init->feature_report_val, sizeof(s_hids_env.feature_report_val));
+    s_hids_env.char_mask = 0xffffffffffffffff;
+    if (p_hids_init->feature_report_count < 2)
+    {
+        s_hids_env.char_mask &= ~(((uint64_t)1 << HIDS_IDX_FEATURE2_REPORT_CHAR) |
+                                  ((uint64_t)1 << HIDS_IDX_FEATURE2_REPORT_VAL)  |
+                                  ((uint64_t)1 << HIDS_IDX_FEATURE2_REPORT_REF));
+    }
     s_hids_env.protocol_mode = DEFAULT_PROTOCOL_MODE;
     s_hids_env.ctrl_pt = INITIAL_VALUE_HID_CONTROL_POINT;
 
@@ -757,7 +806,7 @@ sdk_err_t hids_service_init(hids_init_t *p_hids_init)
 }
 
 
-sdk_err_t hids_input_rep_send(uint8_t conn_idx, uint8_t rep_idx, uint8_t *p_data, uint16_t length)
+USER_RAM_CODE sdk_err_t hids_input_rep_send(uint8_t conn_idx, uint8_t rep_idx, uint8_t *p_data, uint16_t length)
 {
     static const uint8_t char_idx[] = {HIDS_IDX_INPUT1_REPORT_VAL, HIDS_IDX_INPUT2_REPORT_VAL, HIDS_IDX_INPUT3_REPORT_VAL, HIDS_IDX_INPUT4_REPORT_VAL};
     sdk_err_t   error_code = SDK_ERR_NTF_DISABLED;
@@ -765,20 +814,31 @@ sdk_err_t hids_input_rep_send(uint8_t conn_idx, uint8_t rep_idx, uint8_t *p_data
     {
         return SDK_ERR_INVALID_PARAM;
     }
+    USER_PROFILE_START(start);
+    USER_TRACE(TRACE_ID_REPORT_BEGIN, rep_idx, conn_idx);
     length = ((length > HIDS_REPORT_MAX_SIZE) ? HIDS_REPORT_MAX_SIZE : length);
     memcpy(&s_hids_env.input_report_val[rep_idx], p_data, length);
     if(s_hids_env.input_cccd[rep_idx][conn_idx] == PRF_CLI_START_NTF)
     {
         error_code = hids_in_rep_notify(conn_idx, char_idx[rep_idx], p_data, length);
     }
-    if(error_code != SDK_SUCCESS)
-    {
-        printf("hids_input_rep_send ret =%d\r\n",error_code);
-    }
+    USER_TRACE(TRACE_ID_REPORT_END, rep_idx, error_code);
+    USER_PROFILE_STOP(PROFILE_SITE_REPORT_SEND, start);
     return error_code;
 }
 
 
+sdk_err_t hids_feature_rep_set(uint8_t rep_idx, const uint8_t *p_data, uint16_t length)
+{
+    if (rep_idx >= s_hids_env.hids_init.feature_report_count || p_data == NULL ||
+        length > s_hids_env.hids_init.feature_report_array[rep_idx].value_len)
+    {
+        return SDK_ERR_INVALID_PARAM;
+    }
+    memcpy(&s_hids_env.feature_report_val[rep_idx], p_data, length);
+    return SDK_SUCCESS;
+}
+
 sdk_err_t hids_boot_mouse_in_rep_send(uint8_t conn_idx, uint8_t *p_data, uint16_t length)
 {
     sdk_err_t   error_code = SDK_ERR_NTF_DISABLED;
@@ -792,10 +852,6 @@ sdk_err_t hids_boot_mouse_in_rep_send(uint8_t conn_idx, uint8_t *p_data, uint16_
     {
         error_code = hids_in_rep_notify(conn_idx, HIDS_IDX_BOOT_MS_IN_RPT_VAL, p_data, length);
     }
-    if(error_code != SDK_SUCCESS)
-    {
-        printf("hids_boot_mouse_in_rep_send ret =%d\r\n",error_code);
-    }
     return error_code;
 }
 
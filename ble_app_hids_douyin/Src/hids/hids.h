@@ -80,6 +80,7 @@
                                                 10 : CFG_MAX_CONNECTIONS)           /**< Maximum number of Heart Rate Service connections. */
  
 #define HIDS_REPORT_MAX_SIZE                     20       /**< Maximum length of report. */
+#define HIDS_FEATURE_REPORT_MAX_COUNT            2        /**< Maximum number of feature reports. */
 #define HIDS_REPORT_MAP_MAX_SIZE                 512     /**< Limitation of length, as per Section 2.6.1 in HIDS Spec, version 1.0 */
 
 /**
@@ -130,7 +131,8 @@ typedef enum
     HIDS_REPORT_TYPE_IN2,                   /**< The input report2 type. */
     HIDS_REPORT_TYPE_IN3,                   /**< The input report3 type. */
     HIDS_REPORT_TYPE_IN4,
-    HIDS_REPORT_TYPE_FEATURE,               /**< The feature report type. */
+    HIDS_REPORT_TYPE_FEATURE,               /**< The feature report1 type. */
+    HIDS_REPORT_TYPE_FEATURE2,              /**< The feature report2 type. */
     HIDS_REPORT_TYPE_MOUSE_IN,              /**< The boot mouse inputreport type. */
 } hids_report_type_t;
 /** @} */
@@ -204,8 +206,9 @@ typedef struct
     hids_report_map_t   report_map;                         /**< HID Service Report Map characteristic value. */
     uint8_t             input_report_count;
     hids_report_int_t   input_report_array[4]; 
-    hids_report_int_t   count_max_feat_report;
-    uint8_t             count_max_feat[HIDS_REPORT_MAX_SIZE];
+    uint8_t             feature_report_count;                                                   /**< Number of feature reports, at most HIDS_FEATURE_REPORT_MAX_COUNT. */
+    hids_report_int_t   feature_report_array[HIDS_FEATURE_REPORT_MAX_COUNT];                    /**< Feature report characteristics. */
+    uint8_t             feature_report_val[HIDS_FEATURE_REPORT_MAX_COUNT][HIDS_REPORT_MAX_SIZE]; /**< Initial value of each feature report. */
 
 } hids_init_t;
 /** @} */
@@ -240,6 +243,19 @@ sdk_err_t hids_service_init(hids_init_t *p_hids_init);
  */
 sdk_err_t hids_input_rep_send(uint8_t conn_idx, uint8_t rep_idx, uint8_t *p_data, uint16_t length);
 
+/**
+ *****************************************************************************************
+ * @brief Update the value of a feature report, the host reads it on its next request.
+ *
+ * @param[in] rep_idx: Feature report index.
+ * @param[in] p_data: Pointer to the new value.
+ * @param[in] length: Length of the new value.
+ *
+ * @return BLE_SDK_SUCCESS on success, otherwise an error code.
+ *****************************************************************************************
+ */
+sdk_err_t hids_feature_rep_set(uint8_t rep_idx, const uint8_t *p_data, uint16_t length);
+
 /**
  *****************************************************************************************
  * @brief Send boot keyboard input report.
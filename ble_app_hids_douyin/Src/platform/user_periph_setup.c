@@ -47,12 +47,17 @@
 #include "app_pwr_mgmt.h"
 #include "board_SK.h"
 #include "user_mouse.h"
+#include "user_perf.h"
+#include "user_boot.h"
+#include "user_ram.h"
+#include "user_trace.h"
 #include "uart_simu_key_init.h"
 
 /*
  * DEFINES
  *****************************************************************************************
  */
+#define APP_PWR_MGMT_MODE       PMR_MGMT_SLEEP_MODE     /**< Sleep between connection events, user_ram powers the unretained blocks down. */
 
 /*
  * LOCAL VARIABLE DEFINITIONS
@@ -71,7 +76,18 @@ static const uint8_t  s_bd_addr[SYS_BD_ADDR_LEN] = {0x09, 0x00, 0xcf, 0x3e, 0xcb
 void app_periph_init(void)
 {
     SYS_SET_BD_ADDR(s_bd_addr);
-    board_init();
-    pwr_mgmt_mode_set(PMR_MGMT_ACTIVE_MODE);
+    user_perf_init();
+    user_ram_init();
+    // Log first so stack, bond and settings init can report, LEDs wait for app_periph_deferred_init().
+    bsp_log_init();
+    bsp_key_init();
+    user_trace_init();
+    pwr_mgmt_mode_set(APP_PWR_MGMT_MODE);
+    user_boot_mark(BOOT_STAGE_PERIPH);
+}
+
+void app_periph_deferred_init(void)
+{
+    bsp_led_init();
 }
 
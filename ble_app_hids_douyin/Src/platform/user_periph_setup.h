@@ -51,6 +51,13 @@
  */
 void app_periph_init(void);
 
+/**
+ *****************************************************************************************
+ * @brief Init the peripherals not needed to advertise (LED), once advertising started.
+ *****************************************************************************************
+ */
+void app_periph_deferred_init(void);
+
 /**
  *****************************************************************************************
  *@brief Function for Seting bond state
@@ -0,0 +1,248 @@
+/**
+ *****************************************************************************************
+ *
+ * @file stats.c
+ *
+ * @brief Performance Statistics Service implementation.
+ *
+ *****************************************************************************************
+ * @attention
+  #####Copyright (c) 2019 GOODIX
+  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of GOODIX nor the names of its contributors may be used
+    to endorse or promote products derived from this software without
+    specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ *****************************************************************************************
+ */
+#include "stats.h"
+#include "ble_prf_types.h"
+#include "ble_prf_utils.h"
+#include "utility.h"
+
+/*
+ * DEFINES
+ *****************************************************************************************
+ */
+#define STATS_ATT_128_PRIMARY_SERVICE       BLE_ATT_16_TO_128_ARRAY(BLE_ATT_DECL_PRIMARY_SERVICE)
+#define STATS_ATT_128_CHARACTERISTIC        BLE_ATT_16_TO_128_ARRAY(BLE_ATT_DECL_CHARACTERISTIC)
+
+/*
+ * ENUMERATIONS
+ *****************************************************************************************
+ */
+/**@brief STATS Attributes database index list. */
+enum stats_attr_idx_tag
+{
+    STATS_IDX_SVC,
+
+    STATS_IDX_DATA_CHAR,
+    STATS_IDX_DATA_VAL,
+
+    STATS_IDX_CTRL_CHAR,
+    STATS_IDX_CTRL_VAL,
+
+    STATS_IDX_NB,
+};
+
+/*
+ * STRUCT DEFINE
+ *****************************************************************************************
+ */
+/**@brief Statistics Service environment variable. */
+struct stats_env_t
+{
+    stats_init_t              stats_init;                   /**< Statistics Service Init Value. */
+    uint16_t                  start_hdl;                    /**< Statistics Service start handle. */
+    uint8_t                   char_mask;                    /**< Mask of Supported characteristics. */
+    uint8_t                   data[STATS_DATA_MAX_SIZE];    /**< Statistics Data value of the last read. */
+    ble_gatts_create_db_t     stats_gatts_db;               /**< Statistics Service attributs database. */
+};
+
+/*
+ * LOCAL VARIABLE DEFINITIONS
+ *****************************************************************************************
+ */
+static struct stats_env_t s_stats_env;
+static const uint8_t      s_stats_svc_uuid[] = STATS_SERVICE_UUID;
+
+/**@brief Full Statistics Service Database Description - Used to add attributes into the database. */
+static const ble_gatts_attm_desc_128_t stats_attr_tab[STATS_IDX_NB] =
+{
+    // Statistics Service Declaration
+    [STATS_IDX_SVC]       = {STATS_ATT_128_PRIMARY_SERVICE, BLE_GATTS_READ_PERM_UNSEC, 0, 0},
+
+    // Statistics Data Characteristic - Declaration
+    [STATS_IDX_DATA_CHAR] = {STATS_ATT_128_CHARACTERISTIC, BLE_GATTS_READ_PERM_UNSEC, 0, 0},
+    // Statistics Data Characteristic - Value
+    [STATS_IDX_DATA_VAL]  = {STATS_DATA_UUID, BLE_GATTS_READ_PERM(BLE_GATTS_UNAUTH),
+                             (BLE_GATTS_ATT_VAL_LOC_USER | BLE_GATTS_ATT_UUID_TYPE_SET(BLE_GATTS_UUID_TYPE_128)),
+                             STATS_DATA_MAX_SIZE},
+
+    // Statistics Control Point Characteristic - Declaration
+    [STATS_IDX_CTRL_CHAR] = {STATS_ATT_128_CHARACTERISTIC, BLE_GATTS_READ_PERM_UNSEC, 0, 0},
+    // Statistics Control Point Characteristic - Value
+    [STATS_IDX_CTRL_VAL]  = {STATS_CTRL_UUID, BLE_GATTS_WRITE_REQ_PERM(BLE_GATTS_UNAUTH),
+                             (BLE_GATTS_ATT_VAL_LOC_USER | BLE_GATTS_ATT_UUID_TYPE_SET(BLE_GATTS_UUID_TYPE_128)),
+                             sizeof(uint8_t)},
+};
+
+/*
+ * LOCAL FUNCTION DEFINITIONS
+ *****************************************************************************************
+ */
+/**
+ *****************************************************************************************
+ * @brief Handles reception of the read request.
+ *
+ * @param[in] conn_idx: Connection index.
+ * @param[in] p_param:  Pointer to the parameters of the read request.
+ *****************************************************************************************
+ */
+static void stats_read_att_evt_handler(uint8_t conn_idx, const ble_gatts_evt_read_t *p_param)
+{
+    uint8_t              tab_index = prf_find_idx_by_handle(p_param->handle, s_stats_env.start_hdl,
+                                                            STATS_IDX_NB, &s_stats_env.char_mask);
+    ble_gatts_read_cfm_t cfm;
+
+    cfm.handle = p_param->handle;
+    cfm.status = BLE_SUCCESS;
+
+    switch (tab_index)
+    {
+        case STATS_IDX_DATA_VAL:
+            cfm.length = 0;
+            if (s_stats_env.stats_init.data_get)
+            {
+                cfm.length = s_stats_env.stats_init.data_get(s_stats_env.data, sizeof(s_stats_env.data));
+            }
+            cfm.value  = s_stats_env.data;
+            break;
+
+        default:
+            cfm.length = 0;
+            cfm.status = BLE_ATT_ERR_INVALID_HANDLE;
+            break;
+    }
+
+    ble_gatts_read_cfm(conn_idx, &cfm);
+}
+
+/**
+ *****************************************************************************************
+ * @brief Handles reception of the write request.
+ *
+ * @param[in] conn_idx: Connection index.
+ * @param[in] p_param:  Pointer to the parameters of the write request.
+ *****************************************************************************************
+ */
+static void stats_write_att_evt_handler(uint8_t conn_idx, const ble_gatts_evt_write_t *p_param)
+{
+    uint8_t               tab_index = prf_find_idx_by_handle(p_param->handle, s_stats_env.start_hdl,
+                                                             STATS_IDX_NB, &s_stats_env.char_mask);
+    ble_gatts_write_cfm_t cfm;
+    stats_evt_t           evt;
+
+    evt.evt_type = STATS_EVT_INVALID;
+    cfm.handle   = p_param->handle;
+    cfm.status   = BLE_SUCCESS;
+
+    switch (tab_index)
+    {
+        case STATS_IDX_CTRL_VAL:
+            if (p_param->length != sizeof(uint8_t))
+            {
+                cfm.status = BLE_ATT_ERR_INVALID_ATTRIBUTE_VAL_LEN;
+            }
+            else if (p_param->value[0] == STATS_CTRL_RESET)
+            {
+                evt.evt_type = STATS_EVT_RESET;
+            }
+            else
+            {
+                cfm.status = BLE_ATT_ERR_APP_ERROR;
+            }
+            break;
+
+        default:
+            cfm.status = BLE_ATT_ERR_INVALID_HANDLE;
+            break;
+    }
+
+    ble_gatts_write_cfm(conn_idx, &cfm);
+
+    if (STATS_EVT_INVALID != evt.evt_type && s_stats_env.stats_init.evt_handler)
+    {
+        evt.conn_idx = conn_idx;
+        s_stats_env.stats_init.evt_handler(&evt);
+    }
+}
+
+static void stats_ble_evt_handler(const ble_evt_t *p_evt)
+{
+    if (NULL == p_evt)
+    {
+        return;
+    }
+
+    switch (p_evt->evt_id)
+    {
+        case BLE_GATTS_EVT_READ_REQUEST:
+            stats_read_att_evt_handler(p_evt->evt.gatts_evt.index, &p_evt->evt.gatts_evt.params.read_req);
+            break;
+
+        case BLE_GATTS_EVT_WRITE_REQUEST:
+            stats_write_att_evt_handler(p_evt->evt.gatts_evt.index, &p_evt->evt.gatts_evt.params.write_req);
+            break;
+    }
+}
+
+/*
+ * GLOBAL FUNCTION DEFINITIONS
+ *****************************************************************************************
+ */
+sdk_err_t stats_service_init(stats_init_t *p_stats_init)
+{
+    if (NULL == p_stats_init)
+    {
+        return SDK_ERR_POINTER_NULL;
+    }
+    memcpy(&s_stats_env.stats_init, p_stats_init, sizeof(stats_init_t));
+
+    s_stats_env.char_mask  = (1 << STATS_IDX_NB) - 1;
+    s_stats_env.start_hdl  = PRF_INVALID_HANDLE;
+
+    s_stats_env.stats_gatts_db.shdl                  = &s_stats_env.start_hdl;
+    s_stats_env.stats_gatts_db.uuid                  = s_stats_svc_uuid;
+    s_stats_env.stats_gatts_db.attr_tab_cfg          = &s_stats_env.char_mask;
+    s_stats_env.stats_gatts_db.max_nb_attr           = STATS_IDX_NB;
+    s_stats_env.stats_gatts_db.srvc_perm             = BLE_GATTS_SRVC_UUID_TYPE_SET(BLE_GATTS_UUID_TYPE_128);
+    s_stats_env.stats_gatts_db.attr_tab_type         = BLE_GATTS_SERVICE_TABLE_TYPE_128;
+    s_stats_env.stats_gatts_db.attr_tab.attr_tab_128 = stats_attr_tab;
+
+    return ble_gatts_prf_add(&s_stats_env.stats_gatts_db, stats_ble_evt_handler);
+}
@@ -0,0 +1,149 @@
+/**
+ *****************************************************************************************
+ *
+ * @file stats.h
+ *
+ * @brief Performance Statistics Service API.
+ *
+ *****************************************************************************************
+ * @attention
+  #####Copyright (c) 2019 GOODIX
+  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of GOODIX nor the names of its contributors may be used
+    to endorse or promote products derived from this software without
+    specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************************
+ */
+
+/**
+ * @addtogroup BLE_SRV BLE Services
+ * @{
+ * @brief Definitions and prototypes for the BLE Service interface.
+ */
+
+/**
+ * @defgroup BLE_SDK_STATS Performance Statistics Service (STATS)
+ * @{
+ * @brief Definitions and prototypes for the STATS interface.
+ *
+ * @details The vendor Performance Statistics Service exposes runtime counters of the
+ *          device as one binary Statistics Data characteristic, and a Statistics Control
+ *          Point characteristic to reset them.
+ *
+ *          The application provides the data through \ref stats_init_t.data_get, called
+ *          on every read of the Statistics Data characteristic. The value is taken again
+ *          for each Read Blob request, so clients should use an ATT MTU that fits the whole
+ *          value in one read.
+ */
+
+#ifndef __STATS_H__
+#define __STATS_H__
+
+#include "ble_prf_utils.h"
+#include "gr_includes.h"
+#include "custom_config.h"
+#include <stdint.h>
+
+/**
+ * @defgroup STATS_MACRO Defines
+ * @{
+ */
+#define STATS_DATA_MAX_SIZE                 128      /**< Maximum length of the Statistics Data value. */
+
+#define STATS_CTRL_RESET                    0x01     /**< Control Point command: clear all counters. */
+
+/**@brief Service UUID 5A1C0001-6F9E-4C2B-9D3E-8B7A41E2C0D5, characteristics use 0002 and 0003. */
+#define STATS_SERVICE_UUID                  {0xD5, 0xC0, 0xE2, 0x41, 0x7A, 0x8B, 0x3E, 0x9D, \
+                                             0x2B, 0x4C, 0x9E, 0x6F, 0x01, 0x00, 0x1C, 0x5A}
+#define STATS_DATA_UUID                     {0xD5, 0xC0, 0xE2, 0x41, 0x7A, 0x8B, 0x3E, 0x9D, \
+                                             0x2B, 0x4C, 0x9E, 0x6F, 0x02, 0x00, 0x1C, 0x5A}
+#define STATS_CTRL_UUID                     {0xD5, 0xC0, 0xE2, 0x41, 0x7A, 0x8B, 0x3E, 0x9D, \
+                                             0x2B, 0x4C, 0x9E, 0x6F, 0x03, 0x00, 0x1C, 0x5A}
+/** @} */
+
+/**
+ * @defgroup STATS_ENUM Enumerations
+ * @{
+ */
+/**@brief Statistics Service event type. */
+typedef enum
+{
+    STATS_EVT_INVALID,
+    STATS_EVT_RESET,                /**< The peer wrote STATS_CTRL_RESET to the Control Point. */
+} stats_evt_type_t;
+/** @} */
+
+/**
+ * @defgroup STATS_STRUCT Structures
+ * @{
+ */
+/**@brief Statistics Service event. */
+typedef struct
+{
+    uint8_t          conn_idx;      /**< Connection index. */
+    stats_evt_type_t evt_type;      /**< Statistics Service event type. */
+} stats_evt_t;
+/** @} */
+
+/**
+ * @defgroup STATS_TYPEDEF Typedefs
+ * @{
+ */
+/**@brief Statistics Service event handler type. */
+typedef void (*stats_evt_handler_t)(stats_evt_t *p_evt);
+
+/**@brief Fill p_buf with at most max_len bytes of statistics and return the length. */
+typedef uint16_t (*stats_data_get_t)(uint8_t *p_buf, uint16_t max_len);
+/** @} */
+
+/**
+ * @addtogroup STATS_STRUCT Structures
+ * @{
+ */
+/**@brief Statistics Service initialization variable. */
+typedef struct
+{
+    stats_evt_handler_t evt_handler;    /**< Handle events in Statistics Service. */
+    stats_data_get_t    data_get;       /**< Provide the Statistics Data value. */
+} stats_init_t;
+/** @} */
+
+/**
+ * @defgroup STATS_FUNCTION Functions
+ * @{
+ */
+/**
+ *****************************************************************************************
+ * @brief Initialize a Statistics Service instance in ATT DB.
+ *
+ * @param[in] p_stats_init: Pointer to a Statistics Service initialization variable.
+ *
+ * @return Result of service initialization.
+ *****************************************************************************************
+ */
+sdk_err_t stats_service_init(stats_init_t *p_stats_init);
+/** @} */
+
+#endif
+/** @} */
+/** @} */
@@ -40,6 +40,12 @@
  *****************************************************************************************
  */
 #include "user_app.h"
+#include "user_gesture.h"
+#include "user_trace.h"
+#include "user_mem.h"
+#include "user_boot.h"
+#include "user_clock.h"
+#include "user_settings.h"
 #include "user_periph_setup.h"
 #include "gr_includes.h"
 #include "scatter_common.h"
@@ -60,14 +66,23 @@ int main(void)
     // Initialize user peripherals.
     app_periph_init();
 
+    // Paint free stack and heaps for the high-water marks, before the stack uses them.
+    user_mem_paint(&heaps_table);
+    user_boot_mark(BOOT_STAGE_MEM_PAINT);
+
     // Initialize ble stack.
     ble_stack_init(ble_evt_handler, &heaps_table);
+    user_boot_mark(BOOT_STAGE_STACK_INIT);
     // Loop
     while (1)
     {
+        user_clock_schedule();
         app_log_flush();
+        user_trace_flush();
         pwr_mgmt_schedule();
         hid_key_send_schedule();
+        user_gesture_schedule();
+        user_settings_schedule();
     }
 }
 
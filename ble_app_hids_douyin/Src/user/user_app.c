@@ -42,6 +42,20 @@
 #include "user_app.h"
 #include "user_periph_setup.h"
 #include "user_mouse.h"
+#include "user_gesture.h"
+#include "user_perf.h"
+#include "user_latency.h"
+#include "user_trace.h"
+#include "user_stats.h"
+#include "user_mem.h"
+#include "user_boot.h"
+#include "user_ram.h"
+#include "user_clock.h"
+#include "user_conn_timeline.h"
+#include "user_bond.h"
+#include "user_settings.h"
+#include "user_link.h"
+#include "user_evt_ring.h"
 #include "hids.h"
 #include "bas.h"
 #include "dis.h"
@@ -63,6 +77,14 @@
  * DEFINES
  *****************************************************************************************
  */
+/**@brief Key mapping config. */
+#define KEY_ZERO_WAIT_ENABLE                1                   /**< 1: single click fires on key-down, like moves to the UP+OK chord. 0: app_key clicks, like on double click. */
+#define KEY_CHORD_GESTURE                   GESTURE_DOUBLE      /**< Played when both keys go down within the chord window in zero-wait mode. */
+#define KEY_CHORD_WINDOW_MS                 50                  /**< Zero-wait mode: the first key's click is held this long for a chord, 0: no chord and no like. */
+#define KEY_HOLD_DELAY_MS                   500                 /**< Zero-wait mode: hold time before the hold gesture starts repeating. */
+
+/**@brief Security config. */
+#define APP_SEC_LESC_ENABLE                 0                   /**< 1: LE Secure Connections (Just Works), 0: legacy pairing. */
 
 /**@brief Gapm config data. */
 #define DEVICE_NAME                         "Goodix_DY"         /**< Device Name which will be set in GAP. */
@@ -102,9 +124,31 @@ static ble_gap_adv_time_param_t s_gap_adv_time_param;       /**< Advertising tim
 
 static const uint8_t        s_ancs_service_uuid[] = {0xd0, 0x00, 0x2d, 0x12, 0x1e, 0x4b, 0x0f, 0xa4, 0x99,0x4e, 0xce, 0xb5, 0x31, 0xf4, 0x05, 0x79}; //apple ancs
 static bool                 s_peer_os_is_ios;
-static uint8_t              s_key_id;
-static app_key_click_type_t s_key_click_type;
-static volatile uint8_t     s_hid_send_start;
+static bool                 s_peer_os_known;                /**< s_peer_os_is_ios is valid, the ANCS browse is skipped. */
+static user_evt_ring_t      s_key_evt_ring;                 /**< Key events from interrupt context to hid_key_send_schedule(). */
+static uint32_t             s_key_evt_dropped;              /**< Drop count already reported. */
+
+/**@brief Actions of one key. */
+typedef struct
+{
+    uint8_t        key_id;
+    bool           zero_wait;       /**< Fire click on key-down, double click is then unavailable. */
+    gesture_type_t click;
+    gesture_type_t double_click;    /**< Only with zero_wait false. */
+    gesture_type_t hold;            /**< Repeated while the key is held. */
+} key_map_t;
+
+static const key_map_t s_key_map[] =
+{
+    {BSP_KEY_UP_ID, KEY_ZERO_WAIT_ENABLE, GESTURE_UP,   GESTURE_DOUBLE, GESTURE_UP},
+    {BSP_KEY_OK_ID, KEY_ZERO_WAIT_ENABLE, GESTURE_DOWN, GESTURE_DOUBLE, GESTURE_DOWN},
+};
+
+static app_timer_id_t       s_key_chord_timer_id;
+static volatile bool        s_key_chord_due;
+static const key_map_t     *s_key_chord_first;              /**< Zero-wait key whose click is held for a chord. */
+static uint32_t             s_key_chord_timestamp;
+
 /*
  * LOCAL FUNCTION DEFINITIONS
  *****************************************************************************************
@@ -125,7 +169,11 @@ static void app_sec_init(void)
         .level     = BLE_SEC_MODE1_LEVEL2,
         .io_cap    = BLE_SEC_IO_NO_INPUT_NO_OUTPUT,
         .oob       = false,
+#if APP_SEC_LESC_ENABLE
+        .auth      = BLE_SEC_AUTH_BOND | BLE_SEC_AUTH_SEC_CON,
+#else
         .auth      = BLE_SEC_AUTH_BOND ,
+#endif
         .key_size  = 16,
         .ikey_dist = BLE_SEC_KDIST_ENCKEY | BLE_SEC_KDIST_IDKEY,
         .rkey_dist = BLE_SEC_KDIST_ENCKEY | BLE_SEC_KDIST_IDKEY,
@@ -202,6 +250,89 @@ static void dev_mac_info_print(void)
 }
 
 
+/**
+ *****************************************************************************************
+ * @brief Finish the boot once the first advertisement is on air: bring up the LEDs, hand
+ *        the clock to the governor, then print the banner and the boot timeline. The log
+ *        is already up from app_periph_init().
+ *****************************************************************************************
+ */
+static void app_boot_complete(void)
+{
+    sdk_version_t     version;
+
+    app_periph_deferred_init();
+    // Boot runs at full speed, the governor takes over the clock from here on.
+    user_clock_init();
+
+    sys_sdk_verison_get(&version);
+    APP_LOG_INFO("Goodix BLE SDK V%d.%d.%d (commit %x)",
+                version.major, version.minor, version.build, version.commit_id);
+    APP_LOG_INFO("HID DouYin example started.");
+    dev_mac_info_print();
+    APP_LOG_INFO("RAM retained in sleep: %d bytes.", user_ram_retained_size());
+
+    user_boot_mark(BOOT_STAGE_DEFERRED);
+    user_boot_dump();
+}
+
+/**
+ *****************************************************************************************
+ * @brief Remember the OS of a bonded peer for its next connection.
+ *****************************************************************************************
+ */
+static void app_peer_os_save(uint8_t conn_idx)
+{
+    user_bond_peer_t *p_bond = user_bond_peer_get(conn_idx);
+
+    if (p_bond)
+    {
+        p_bond->flags &= ~USER_BOND_FLAG_IOS;
+        p_bond->flags |= USER_BOND_FLAG_OS_KNOWN | (s_peer_os_is_ios ? USER_BOND_FLAG_IOS : 0);
+        user_bond_peer_save(conn_idx);
+    }
+}
+
+/**
+ *****************************************************************************************
+ * @brief Connection parameters within the preferred range.
+ *****************************************************************************************
+ */
+static bool app_conn_param_preferred(uint16_t interval, uint16_t latency)
+{
+    return interval >= MIN_CONN_INTERVAL && interval <= MAX_CONN_INTERVAL && latency <= SLAVE_LATENCY;
+}
+
+/**
+ *****************************************************************************************
+ * @brief Remember the connection parameters a bonded peer settled on within the preferred
+ *        range, the next connection narrows its request to them. A slower negotiation,
+ *        such as an iPhone in background, is not kept.
+ *****************************************************************************************
+ */
+static void app_peer_conn_param_save(uint8_t conn_idx, const ble_gap_evt_conn_param_updated_t *p_param)
+{
+    user_bond_peer_t *p_bond = user_bond_peer_get(conn_idx);
+
+    if (!app_conn_param_preferred(p_param->interval, p_param->latency))
+    {
+        return;
+    }
+    if (p_bond && (!(p_bond->flags & USER_BOND_FLAG_CONN_PARAM) ||
+                   p_bond->conn_interval != p_param->interval || p_bond->conn_latency != p_param->latency))
+    {
+        p_bond->flags        |= USER_BOND_FLAG_CONN_PARAM;
+        p_bond->conn_interval = p_param->interval;
+        p_bond->conn_latency  = p_param->latency;
+        user_bond_peer_save(conn_idx);
+    }
+}
+
+static void key_chord_timer_handler(void *p_arg)
+{
+    s_key_chord_due = true;
+}
+
 /**
  *****************************************************************************************
  * @brief Initialize services.
@@ -209,7 +340,17 @@ static void dev_mac_info_print(void)
  */
 static void services_init(void)
 {
+    sdk_err_t error_code;
+
+    error_code = app_timer_create(&s_key_chord_timer_id, ATIMER_ONE_SHOT, key_chord_timer_handler);
+    APP_ERROR_CHECK(error_code);
+
     user_mouse_service_init();
+    user_stats_init();
+    user_settings_init();
+    user_bond_init();
+    user_link_init();
+    user_gesture_init();
 }
 
 static void app_paring_succeed_handler(uint8_t conn_idx)
@@ -236,9 +377,18 @@ static void app_sec_rcv_enc_req_handler(uint8_t conn_idx, const ble_sec_evt_enc_
     switch (p_enc_req->req_type)
     {
         case BLE_SEC_PAIR_REQ:
+            user_conn_timeline_mark(conn_idx, CONN_PHASE_PAIR_REQ, 0);
+            user_bond_pairing_start(conn_idx);
             cfm_enc.req_type = BLE_SEC_PAIR_REQ;
             cfm_enc.accept   = true;
             break;
+
+        case BLE_SEC_NC_REQ:
+            // LESC Just Works, there is no display to compare, accept right away.
+            user_conn_timeline_mark(conn_idx, CONN_PHASE_NC_REQ, 0);
+            cfm_enc.req_type = BLE_SEC_NC_REQ;
+            cfm_enc.accept   = true;
+            break;
         default:
             break;
     }
@@ -249,11 +399,26 @@ void app_disconnected_handler(uint8_t conn_idx, uint8_t reason)
 {
     APP_LOG_INFO("Disconnected (0x%02X).", reason);
     s_peer_os_is_ios = false;
+    s_peer_os_known  = false;
+    user_link_disconnected(conn_idx, reason);
+    user_bond_disconnected(conn_idx);
+    user_mouse_disconnected(conn_idx);
+    user_gesture_abort();
+    user_latency_abort();
+    user_stats_disconnected(reason);
+    user_latency_dump();
+    user_clock_release(CLOCK_USER_PAIRING);
+    user_perf_profile_dump();
+    user_mem_dump();
+    user_clock_dump();
     app_adv_start();
 }
 
 void app_connected_handler(uint8_t conn_idx, const ble_gap_evt_connected_t *p_param)
 {
+    ble_gap_bdaddr_t  peer_addr;
+    user_bond_peer_t *p_bond;
+
     APP_LOG_INFO("Connect Peer Addr: %02X:%02X:%02X:%02X:%02X:%02X.",
                 p_param->peer_addr.addr[5],
                 p_param->peer_addr.addr[4],
@@ -261,21 +426,55 @@ void app_connected_handler(uint8_t conn_idx, const ble_gap_evt_connected_t *p_pa
                 p_param->peer_addr.addr[2],
                 p_param->peer_addr.addr[1],
                 p_param->peer_addr.addr[0]);
+    user_mouse_pointer_invalidate(conn_idx);
+    user_stats_connected();
+    user_conn_timeline_mark(conn_idx, CONN_PHASE_CONNECTED, 0);
+
+    // Encryption, connection parameters and OS lookup all start now and run concurrently.
+    peer_addr.addr_type = p_param->peer_addr_type;
+    peer_addr.gap_addr  = p_param->peer_addr;
+    p_bond = user_bond_connected(conn_idx, &peer_addr);
+    if (p_bond)
+    {
+        // Ask a bonded peer to encrypt now instead of waiting for it to start.
+        if (SDK_SUCCESS == ble_sec_enc_start(conn_idx))
+        {
+            user_conn_timeline_mark(conn_idx, CONN_PHASE_SEC_REQ, 0);
+        }
+        if (p_bond->flags & USER_BOND_FLAG_OS_KNOWN)
+        {
+            s_peer_os_is_ios = (p_bond->flags & USER_BOND_FLAG_IOS) != 0;
+            s_peer_os_known  = true;
+            user_conn_timeline_mark(conn_idx, CONN_PHASE_OS_KNOWN, 0);
+        }
+    }
+    user_link_connected(conn_idx);
 
-    // update interval to 15ms 
+    // update interval to 15ms, or straight to the interval in that range this peer settled on last time
     ble_gap_conn_update_param_t gap_conn_param;
     gap_conn_param.interval_min  = MIN_CONN_INTERVAL;
     gap_conn_param.interval_max  = MAX_CONN_INTERVAL;
     gap_conn_param.slave_latency = SLAVE_LATENCY;
     gap_conn_param.sup_timeout   = CONN_SUP_TIMEOUT;
+    if (p_bond && (p_bond->flags & USER_BOND_FLAG_CONN_PARAM) &&
+        app_conn_param_preferred(p_bond->conn_interval, p_bond->conn_latency))
+    {
+        gap_conn_param.interval_min  = p_bond->conn_interval;
+        gap_conn_param.interval_max  = p_bond->conn_interval;
+        gap_conn_param.slave_latency = p_bond->conn_latency;
+    }
     ble_gap_conn_param_update(conn_idx,&gap_conn_param);
 }
 /*
  * GLOBAL FUNCTION DEFINITIONS
  ****************************************************************************************
  */
-void ble_evt_handler(const ble_evt_t *p_evt)
+USER_RAM_CODE void ble_evt_handler(const ble_evt_t *p_evt)
 {
+    USER_PROFILE_START(start);
+    USER_TRACE(TRACE_ID_BLE_EVT, p_evt->evt_status, p_evt->evt_id);
+    user_settings_activity();
+
     switch(p_evt->evt_id)
     {
         case BLE_COMMON_EVT_STACK_INIT:
@@ -284,6 +483,14 @@ void ble_evt_handler(const ble_evt_t *p_evt)
             }
             break;
 
+        case BLE_GAPM_EVT_ADV_START:
+            if (BLE_SUCCESS == p_evt->evt_status && !user_boot_stage_reached(BOOT_STAGE_ADV_STARTED))
+            {
+                user_boot_mark(BOOT_STAGE_ADV_STARTED);
+                app_boot_complete();
+            }
+            break;
+
         case BLE_GAPC_EVT_CONN_PARAM_UPDATE_REQ:
             {
                 ble_gap_conn_param_update_reply(p_evt->evt.gapc_evt.index, true);
@@ -292,15 +499,22 @@ void ble_evt_handler(const ble_evt_t *p_evt)
 
         case BLE_SEC_EVT_LINK_ENC_REQUEST:
             {
+                user_clock_request(CLOCK_USER_PAIRING);
                 app_sec_rcv_enc_req_handler(p_evt->evt.sec_evt.index, &(p_evt->evt.sec_evt.params.enc_req));
             }
             break;
 
         case BLE_SEC_EVT_LINK_ENCRYPTED:
+            user_clock_release(CLOCK_USER_PAIRING);
+            user_conn_timeline_mark(p_evt->evt.sec_evt.index, CONN_PHASE_ENCRYPTED, p_evt->evt_status);
             if (BLE_SUCCESS == p_evt->evt_status)
             {
                 APP_LOG_INFO("Link has been successfully encrypted.");
-                app_paring_succeed_handler(p_evt->evt.sec_evt.index);
+                user_bond_encrypted(p_evt->evt.sec_evt.index);
+                if (!s_peer_os_known)
+                {
+                    app_paring_succeed_handler(p_evt->evt.sec_evt.index);
+                }
             }
             else
             {
@@ -309,10 +523,38 @@ void ble_evt_handler(const ble_evt_t *p_evt)
             break;
 
         case BLE_GATTC_EVT_SRVC_BROWSE:
-            if(p_evt->evt_status == BLE_SUCCESS)
+            // Only a found ANCS or a completed browse without it is cached, a transient error
+            // or a browse cut short by a disconnect leaves the OS to the next connection.
+            if (s_peer_os_known)
+            {
+                break;
+            }
+            if (p_evt->evt_status == BLE_SUCCESS)
             {
                 s_peer_os_is_ios = true;
             }
+            else if (p_evt->evt_status != BLE_ATT_ERR_ATTRIBUTE_NOT_FOUND &&
+                     p_evt->evt_status != BLE_GATT_ERR_BROWSE_NO_ANY_MORE)
+            {
+                APP_LOG_WARNING("ANCS browse failed (0x%x), OS left unknown.", p_evt->evt_status);
+                break;
+            }
+            s_peer_os_known = true;
+            app_peer_os_save(p_evt->evt.gattc_evt.index);
+            user_conn_timeline_mark(p_evt->evt.gattc_evt.index, CONN_PHASE_OS_KNOWN, 0);
+            break;
+
+        case BLE_GAPC_EVT_CONN_PARAM_UPDATED:
+            user_conn_timeline_mark(p_evt->evt.gapc_evt.index, CONN_PHASE_PARAM_UPDATED, 0);
+            app_peer_conn_param_save(p_evt->evt.gapc_evt.index, &p_evt->evt.gapc_evt.params.conn_param_updated);
+            break;
+
+        case BLE_GAPC_EVT_PHY_UPDATED:
+            user_link_phy_updated(p_evt->evt.gapc_evt.index, p_evt->evt_status, &p_evt->evt.gapc_evt.params.phy_update);
+            break;
+
+        case BLE_GAPC_EVT_CONN_INFO_GOT:
+            user_link_conn_info(p_evt->evt.gapc_evt.index, p_evt->evt_status, &p_evt->evt.gapc_evt.params.conn_info);
             break;
             
         case BLE_GAPC_EVT_CONNECTED:
@@ -326,62 +568,247 @@ void ble_evt_handler(const ble_evt_t *p_evt)
                 app_disconnected_handler(p_evt->evt.gapc_evt.index,p_evt->evt.gapc_evt.params.disconnected.reason);
             }
             break;
+
+        case BLE_GATTS_EVT_NTF_IND:
+            if (BLE_SUCCESS == p_evt->evt_status)
+            {
+                USER_TRACE(TRACE_ID_NTF_DONE, p_evt->evt.gatts_evt.index, p_evt->evt.gatts_evt.params.ntf_ind_sended.handle);
+                user_latency_ntf_sent();
+                user_stats_ntf_sent();
+                user_link_ntf_sent(p_evt->evt.gatts_evt.index);
+            }
+            break;
     }
+    USER_PROFILE_STOP(PROFILE_SITE_BLE_EVT, start);
 }
 
 void ble_app_init(void)
 {
-    sdk_version_t     version;
-
-    sys_sdk_verison_get(&version);
-    APP_LOG_INFO("Goodix BLE SDK V%d.%d.%d (commit %x)",
-                version.major, version.minor, version.build, version.commit_id);
-    APP_LOG_INFO("HID DouYin example started.");
-    dev_mac_info_print();
+    user_boot_mark(BOOT_STAGE_STACK_READY);
     services_init();
 
     app_adv_init();
     app_sec_init();
+    user_boot_mark(BOOT_STAGE_SERVICES);
     app_adv_start();
+    user_boot_mark(BOOT_STAGE_ADV_REQ);
 }
 
- void app_key_evt_handler(uint8_t key_id, app_key_click_type_t key_click_type)
+/**
+ *****************************************************************************************
+ * @brief Find the mapping of a key, NULL if the key is not mapped.
+ *****************************************************************************************
+ */
+static const key_map_t *key_map_find(uint8_t key_id)
 {
-    s_key_id = key_id;
-    s_key_click_type = key_click_type;
-    s_hid_send_start = true;
-    APP_LOG_INFO("Start! \n");
+    for (uint8_t i = 0; i < sizeof(s_key_map) / sizeof(s_key_map[0]); i++)
+    {
+        if (s_key_map[i].key_id == key_id)
+        {
+            return &s_key_map[i];
+        }
+    }
+    return NULL;
 }
 
-void hid_key_send_schedule(void)
+/**
+ *****************************************************************************************
+ * @brief Start the gesture of a key event, latency is measured from the event that
+ *        started a gesture, not from a release or an unmapped click.
+ *****************************************************************************************
+ */
+static void key_gesture_start(gesture_type_t type, uint32_t timestamp)
 {
-    if (!s_hid_send_start)
+    if (type == GESTURE_NONE)
     {
         return;
     }
-    if (s_key_click_type == APP_KEY_SINGLE_CLICK)
+    user_latency_key_event(timestamp);
+    user_gesture_start(0, type, s_peer_os_is_ios);
+}
+
+/**
+ *****************************************************************************************
+ * @brief Zero-wait click: play it and repeat the hold gesture if the key stays down.
+ *****************************************************************************************
+ */
+static void key_click_play(const key_map_t *p_map, uint32_t timestamp)
+{
+    APP_LOG_INFO("Key %d down! \n", p_map->key_id);
+    key_gesture_start(p_map->click, timestamp);
+    if (p_map->hold != GESTURE_NONE)
     {
-        switch (s_key_id)
+        user_gesture_repeat_start(0, p_map->hold, s_peer_os_is_ios, bsp_key_is_pressed, p_map->key_id, KEY_HOLD_DELAY_MS);
+    }
+}
+
+/**
+ *****************************************************************************************
+ * @brief Play the click held for a chord, if any. Latency still counts from its key-down.
+ *****************************************************************************************
+ */
+static void key_chord_flush(void)
+{
+    const key_map_t *p_map = s_key_chord_first;
+
+    app_timer_stop(s_key_chord_timer_id);
+    s_key_chord_due   = false;
+    s_key_chord_first = NULL;
+    if (p_map != NULL)
+    {
+        key_click_play(p_map, s_key_chord_timestamp);
+    }
+}
+
+/**
+ *****************************************************************************************
+ * @brief Zero-wait key-down. With the chord enabled the click is held for the chord
+ *        window, a swipe already sent cannot be taken back on iOS. The other key going
+ *        down within the window replaces it with the chord gesture.
+ *****************************************************************************************
+ */
+static void key_down_process(const key_map_t *p_map, uint32_t timestamp)
+{
+#if KEY_CHORD_WINDOW_MS
+    if (s_key_chord_first != NULL && s_key_chord_first != p_map)
+    {
+        app_timer_stop(s_key_chord_timer_id);
+        s_key_chord_due   = false;
+        s_key_chord_first = NULL;
+        APP_LOG_INFO("Key chord! \n");
+        key_gesture_start(KEY_CHORD_GESTURE, timestamp);
+        return;
+    }
+    key_chord_flush();
+    s_key_chord_first     = p_map;
+    s_key_chord_timestamp = timestamp;
+    app_timer_start(s_key_chord_timer_id, KEY_CHORD_WINDOW_MS, NULL);
+#else
+    key_click_play(p_map, timestamp);
+#endif
+}
+
+/**
+ *****************************************************************************************
+ * @brief app_key click of a key that is not zero-wait.
+ *****************************************************************************************
+ */
+static void key_click_process(const key_map_t *p_map, app_key_click_type_t click_type, uint32_t timestamp)
+{
+    switch (click_type)
+    {
+        case APP_KEY_SINGLE_CLICK:
+            APP_LOG_INFO("Key %d clicked! \n", p_map->key_id);
+            key_gesture_start(p_map->click, timestamp);
+            break;
+
+        case APP_KEY_DOUBLE_CLICK:
+            key_gesture_start(p_map->double_click, timestamp);
+            break;
+
+        case APP_KEY_LONG_CLICK:
+            // Keep swiping the feed until the key is released.
+            APP_LOG_INFO("Key %d long pressed! \n", p_map->key_id);
+            if (p_map->hold != GESTURE_NONE)
+            {
+                user_latency_key_event(timestamp);
+            }
+            user_gesture_repeat_start(0, p_map->hold, s_peer_os_is_ios, bsp_key_is_pressed, p_map->key_id, 0);
+            break;
+
+        default:
+            break;
+    }
+}
+
+/**
+ *****************************************************************************************
+ * @brief Timestamp a key event and push it to the event ring, interrupt context.
+ *****************************************************************************************
+ */
+static void key_evt_push(user_evt_type_t type, uint8_t key_id, app_key_click_type_t click_type)
+{
+    user_evt_t evt;
+
+    evt.timestamp  = user_perf_now_us();
+    evt.type       = type;
+    evt.key_id     = key_id;
+    evt.click_type = click_type;
+    USER_TRACE(TRACE_ID_KEY_IRQ, key_id, type);
+    user_evt_ring_push(&s_key_evt_ring, &evt);
+}
+
+bool app_key_zero_wait_check(uint8_t key_id)
+{
+    const key_map_t *p_map = key_map_find(key_id);
+
+    return p_map ? p_map->zero_wait : false;
+}
+
+void app_key_down_handler(uint8_t key_id)
+{
+    key_evt_push(USER_EVT_KEY_DOWN, key_id, APP_KEY_NO_CLICK);
+}
+
+void app_key_up_handler(uint8_t key_id)
+{
+    key_evt_push(USER_EVT_KEY_UP, key_id, APP_KEY_NO_CLICK);
+}
+
+void app_key_evt_handler(uint8_t key_id, app_key_click_type_t key_click_type)
+{
+    key_evt_push(USER_EVT_KEY_CLICK, key_id, key_click_type);
+}
+
+void hid_key_send_schedule(void)
+{
+    user_evt_t       evt;
+    const key_map_t *p_map;
+    uint32_t         dropped = s_key_evt_ring.dropped;
+
+    user_stats_key_queue(s_key_evt_ring.head - s_key_evt_ring.tail, dropped - s_key_evt_dropped);
+    if (dropped != s_key_evt_dropped)
+    {
+        s_key_evt_dropped = dropped;
+        APP_LOG_WARNING("Key events dropped: %d", s_key_evt_dropped);
+    }
+
+    while (user_evt_ring_pop(&s_key_evt_ring, &evt))
+    {
+        p_map = key_map_find(evt.key_id);
+        if (p_map == NULL)
         {
-            case BSP_KEY_UP_ID:
-                APP_LOG_INFO("Up key Clicked! \n");
-                touch_up(s_peer_os_is_ios);
+            continue;
+        }
+        // Latency is counted from the moment the event happened, not from when it is handled.
+        switch (evt.type)
+        {
+            case USER_EVT_KEY_DOWN:
+                key_down_process(p_map, evt.timestamp);
+                break;
+
+            case USER_EVT_KEY_UP:
+                if (s_key_chord_first == p_map)
+                {
+                    // Released within the window, no chord: the click goes out now.
+                    key_chord_flush();
+                }
+                if (p_map->hold != GESTURE_NONE)
+                {
+                    user_gesture_repeat_stop();
+                }
                 break;
 
-            case BSP_KEY_DOWN_ID:
-                APP_LOG_INFO("Down key Clicked! \n");
-                touch_down(s_peer_os_is_ios);
+            case USER_EVT_KEY_CLICK:
+                key_click_process(p_map, (app_key_click_type_t)evt.click_type, evt.timestamp);
                 break;
 
             default:
                 break;
         }
     }
-    else if (s_key_click_type == APP_KEY_DOUBLE_CLICK)
+    if (s_key_chord_due)
     {
-        touch_double(s_peer_os_is_ios);
+        key_chord_flush();
     }
-
-    s_hid_send_start = false;
 }
-
@@ -0,0 +1,343 @@
+/**
+ *****************************************************************************************
+ *
+ * @file user_bond.c
+ *
+ * @brief Application bond table implementation.
+ *
+ *****************************************************************************************
+ * @attention
+  #####Copyright (c) 2019 GOODIX
+  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of GOODIX nor the names of its contributors may be used
+    to endorse or promote products derived from this software without
+    specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************************
+ */
+/*
+ * INCLUDE FILES
+ *****************************************************************************************
+ */
+#include "user_bond.h"
+#include "user_settings.h"
+#include "app_log.h"
+#include <string.h>
+
+/*
+ * DEFINES
+ *****************************************************************************************
+ */
+#define BOND_HASH_SIZE              8           /**< Power of two, twice the table for short probes. */
+#define BOND_SLOT_NONE              0xFF
+
+/*
+ * STRUCT DEFINE
+ *****************************************************************************************
+ */
+/**@brief One table slot, the peer record mirrors NVDS tag NV_TAG_APP(USER_BOND_NV_TAG_BASE + slot). */
+typedef struct
+{
+    bool             valid;
+    user_bond_peer_t peer;
+} bond_slot_t;
+
+/*
+ * LOCAL VARIABLE DEFINITIONS
+ *****************************************************************************************
+ */
+static bond_slot_t s_bond_slot[CFG_MAX_BOND_DEVS];
+static uint8_t     s_bond_hash[BOND_HASH_SIZE];             /**< Slot index per hash bucket, linear probing. */
+static uint8_t     s_bond_conn_slot[CFG_MAX_CONNECTIONS];   /**< Slot of the peer on each link. */
+static uint32_t    s_bond_lru_clock;
+
+/*
+ * LOCAL FUNCTION DEFINITIONS
+ *****************************************************************************************
+ */
+static bool bond_addr_equal(const ble_gap_bdaddr_t *p_a, const ble_gap_bdaddr_t *p_b)
+{
+    return 0 == memcmp(p_a->gap_addr.addr, p_b->gap_addr.addr, BLE_GAP_ADDR_LEN);
+}
+
+static uint8_t bond_hash(const ble_gap_bdaddr_t *p_addr)
+{
+    const uint8_t *p = p_addr->gap_addr.addr;
+
+    return (p[0] ^ p[1] ^ p[2] ^ p[3] ^ p[4] ^ p[5]) & (BOND_HASH_SIZE - 1);
+}
+
+static void bond_hash_rebuild(void)
+{
+    uint8_t bucket;
+
+    memset(s_bond_hash, BOND_SLOT_NONE, sizeof(s_bond_hash));
+    for (uint8_t slot = 0; slot < CFG_MAX_BOND_DEVS; slot++)
+    {
+        if (!s_bond_slot[slot].valid)
+        {
+            continue;
+        }
+        bucket = bond_hash(&s_bond_slot[slot].peer.identity);
+        while (s_bond_hash[bucket] != BOND_SLOT_NONE)
+        {
+            bucket = (bucket + 1) & (BOND_HASH_SIZE - 1);
+        }
+        s_bond_hash[bucket] = slot;
+    }
+}
+
+static uint8_t bond_find(const ble_gap_bdaddr_t *p_addr)
+{
+    uint8_t bucket = bond_hash(p_addr);
+    uint8_t slot;
+
+    for (uint8_t i = 0; i < BOND_HASH_SIZE; i++)
+    {
+        slot = s_bond_hash[bucket];
+        if (slot == BOND_SLOT_NONE)
+        {
+            break;
+        }
+        if (bond_addr_equal(&s_bond_slot[slot].peer.identity, p_addr))
+        {
+            return slot;
+        }
+        bucket = (bucket + 1) & (BOND_HASH_SIZE - 1);
+    }
+    return BOND_SLOT_NONE;
+}
+
+static void bond_slot_save(uint8_t slot)
+{
+    user_settings_dirty(NV_TAG_APP(USER_BOND_NV_TAG_BASE + slot));
+}
+
+static void bond_slot_free(uint8_t slot)
+{
+    s_bond_slot[slot].valid = false;
+    user_settings_erase(NV_TAG_APP(USER_BOND_NV_TAG_BASE + slot));
+    for (uint8_t i = 0; i < CFG_MAX_CONNECTIONS; i++)
+    {
+        if (s_bond_conn_slot[i] == slot)
+        {
+            s_bond_conn_slot[i] = BOND_SLOT_NONE;
+        }
+    }
+}
+
+static uint8_t bond_slot_add(const ble_gap_bdaddr_t *p_addr)
+{
+    for (uint8_t slot = 0; slot < CFG_MAX_BOND_DEVS; slot++)
+    {
+        if (!s_bond_slot[slot].valid)
+        {
+            memset(&s_bond_slot[slot].peer, 0, sizeof(user_bond_peer_t));
+            s_bond_slot[slot].valid             = true;
+            s_bond_slot[slot].peer.version      = USER_BOND_RECORD_VERSION;
+            s_bond_slot[slot].peer.identity     = *p_addr;
+            s_bond_slot[slot].peer.last_used    = ++s_bond_lru_clock;
+            bond_slot_save(slot);
+            return slot;
+        }
+    }
+    return BOND_SLOT_NONE;
+}
+
+static bool bond_slot_connected(uint8_t slot)
+{
+    for (uint8_t i = 0; i < CFG_MAX_CONNECTIONS; i++)
+    {
+        if (s_bond_conn_slot[i] == slot)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * GLOBAL FUNCTION DEFINITIONS
+ *****************************************************************************************
+ */
+void user_bond_init(void)
+{
+    ble_gap_bond_dev_list_t bond_list;
+    uint16_t                len;
+    bool                    loaded;
+    bool                    found;
+
+    memset(s_bond_conn_slot, BOND_SLOT_NONE, sizeof(s_bond_conn_slot));
+    if (SDK_SUCCESS != ble_gap_bond_devs_get(&bond_list))
+    {
+        bond_list.num = 0;
+    }
+
+    // Keep the records of peers still bonded in the stack, drop the others.
+    for (uint8_t slot = 0; slot < CFG_MAX_BOND_DEVS; slot++)
+    {
+        len    = sizeof(user_bond_peer_t);
+        loaded = (NVDS_SUCCESS == nvds_get(NV_TAG_APP(USER_BOND_NV_TAG_BASE + slot), &len, (uint8_t *)&s_bond_slot[slot].peer));
+        user_settings_register(NV_TAG_APP(USER_BOND_NV_TAG_BASE + slot), &s_bond_slot[slot].peer, sizeof(user_bond_peer_t));
+        if (!loaded)
+        {
+            continue;
+        }
+        if (len != sizeof(user_bond_peer_t) || s_bond_slot[slot].peer.version != USER_BOND_RECORD_VERSION)
+        {
+            bond_slot_free(slot);
+            continue;
+        }
+        found = false;
+        for (uint8_t i = 0; i < bond_list.num && !found; i++)
+        {
+            found = bond_addr_equal(&bond_list.items[i], &s_bond_slot[slot].peer.identity);
+        }
+        if (!found)
+        {
+            bond_slot_free(slot);
+            continue;
+        }
+        s_bond_slot[slot].valid = true;
+        if (s_bond_slot[slot].peer.last_used > s_bond_lru_clock)
+        {
+            s_bond_lru_clock = s_bond_slot[slot].peer.last_used;
+        }
+    }
+    bond_hash_rebuild();
+
+    // Stack bonds without a record, from before this table existed, start with default settings.
+    for (uint8_t i = 0; i < bond_list.num; i++)
+    {
+        if (bond_find(&bond_list.items[i]) == BOND_SLOT_NONE && bond_slot_add(&bond_list.items[i]) != BOND_SLOT_NONE)
+        {
+            bond_hash_rebuild();
+        }
+    }
+}
+
+user_bond_peer_t *user_bond_connected(uint8_t conn_idx, const ble_gap_bdaddr_t *p_addr)
+{
+    uint8_t slot;
+
+    if (conn_idx >= CFG_MAX_CONNECTIONS)
+    {
+        return NULL;
+    }
+    slot = bond_find(p_addr);
+    s_bond_conn_slot[conn_idx] = slot;
+    if (slot == BOND_SLOT_NONE)
+    {
+        return NULL;
+    }
+    // Coalesced by the settings store, the write waits for an idle link.
+    s_bond_slot[slot].peer.last_used = ++s_bond_lru_clock;
+    bond_slot_save(slot);
+    return &s_bond_slot[slot].peer;
+}
+
+user_bond_peer_t *user_bond_peer_get(uint8_t conn_idx)
+{
+    if (conn_idx >= CFG_MAX_CONNECTIONS || s_bond_conn_slot[conn_idx] == BOND_SLOT_NONE)
+    {
+        return NULL;
+    }
+    return &s_bond_slot[s_bond_conn_slot[conn_idx]].peer;
+}
+
+void user_bond_pairing_start(uint8_t conn_idx)
+{
+    ble_gap_bond_dev_list_t bond_list;
+    uint8_t                 victim = BOND_SLOT_NONE;
+
+    if (user_bond_peer_get(conn_idx) != NULL ||
+        SDK_SUCCESS != ble_gap_bond_devs_get(&bond_list) || bond_list.num < CFG_MAX_BOND_DEVS)
+    {
+        return;
+    }
+
+    for (uint8_t slot = 0; slot < CFG_MAX_BOND_DEVS; slot++)
+    {
+        if (s_bond_slot[slot].valid && !bond_slot_connected(slot) &&
+            (victim == BOND_SLOT_NONE || s_bond_slot[slot].peer.last_used < s_bond_slot[victim].peer.last_used))
+        {
+            victim = slot;
+        }
+    }
+    if (victim == BOND_SLOT_NONE)
+    {
+        APP_LOG_WARNING("Bond list full, every bonded peer is connected.");
+        return;
+    }
+
+    APP_LOG_INFO("Bond list full, evicting %02X:%02X:%02X:%02X:%02X:%02X.",
+                 s_bond_slot[victim].peer.identity.gap_addr.addr[5], s_bond_slot[victim].peer.identity.gap_addr.addr[4],
+                 s_bond_slot[victim].peer.identity.gap_addr.addr[3], s_bond_slot[victim].peer.identity.gap_addr.addr[2],
+                 s_bond_slot[victim].peer.identity.gap_addr.addr[1], s_bond_slot[victim].peer.identity.gap_addr.addr[0]);
+    ble_gap_bond_dev_del(&s_bond_slot[victim].peer.identity);
+    bond_slot_free(victim);
+    bond_hash_rebuild();
+}
+
+void user_bond_encrypted(uint8_t conn_idx)
+{
+    ble_gap_bond_dev_list_t bond_list;
+    uint8_t                 slot;
+
+    if (conn_idx >= CFG_MAX_CONNECTIONS || s_bond_conn_slot[conn_idx] != BOND_SLOT_NONE ||
+        SDK_SUCCESS != ble_gap_bond_devs_get(&bond_list))
+    {
+        return;
+    }
+
+    // The stack keys the new bond by the identity address the peer distributed, which can
+    // differ from the address it connected with: the bond without a record is this peer.
+    for (uint8_t i = 0; i < bond_list.num; i++)
+    {
+        if (bond_find(&bond_list.items[i]) == BOND_SLOT_NONE)
+        {
+            slot = bond_slot_add(&bond_list.items[i]);
+            if (slot != BOND_SLOT_NONE)
+            {
+                bond_hash_rebuild();
+                s_bond_conn_slot[conn_idx] = slot;
+            }
+            return;
+        }
+    }
+}
+
+void user_bond_peer_save(uint8_t conn_idx)
+{
+    if (user_bond_peer_get(conn_idx) != NULL)
+    {
+        bond_slot_save(s_bond_conn_slot[conn_idx]);
+    }
+}
+
+void user_bond_disconnected(uint8_t conn_idx)
+{
+    if (conn_idx < CFG_MAX_CONNECTIONS)
+    {
+        s_bond_conn_slot[conn_idx] = BOND_SLOT_NONE;
+    }
+}
@@ -0,0 +1,134 @@
+/**
+ *****************************************************************************************
+ *
+ * @file user_bond.h
+ *
+ * @brief Application bond table, mirrors the stack bond list and keeps per-peer settings.
+ *
+ *****************************************************************************************
+ * @attention
+  #####Copyright (c) 2019 GOODIX
+  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of GOODIX nor the names of its contributors may be used
+    to endorse or promote products derived from this software without
+    specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************************
+ */
+#ifndef __USER_BOND_H__
+#define __USER_BOND_H__
+
+/*
+ * INCLUDE FILES
+ *****************************************************************************************
+ */
+#include "gr_includes.h"
+#include "custom_config.h"
+
+/*
+ * DEFINES
+ *****************************************************************************************
+ */
+#define USER_BOND_NV_TAG_BASE       0x10        /**< NVDS tags NV_TAG_APP(base) .. NV_TAG_APP(base + CFG_MAX_BOND_DEVS - 1), written through user_settings. */
+#define USER_BOND_RECORD_VERSION    1
+
+#define USER_BOND_FLAG_OS_KNOWN     0x01        /**< USER_BOND_FLAG_IOS is valid. */
+#define USER_BOND_FLAG_IOS          0x02        /**< Peer runs iOS (ANCS found). */
+#define USER_BOND_FLAG_CONN_PARAM   0x04        /**< conn_interval holds the interval the peer settled on. */
+#define USER_BOND_FLAG_PHY_1M       0x08        /**< 2M failed on the last link, stay on 1M. */
+
+/*
+ * TYPEDEFS
+ *****************************************************************************************
+ */
+/**@brief Per-peer settings, stored as one NVDS record per bonded peer. */
+typedef struct
+{
+    uint8_t          version;           /**< USER_BOND_RECORD_VERSION. */
+    uint8_t          flags;             /**< USER_BOND_FLAG_XXX. */
+    ble_gap_bdaddr_t identity;          /**< Identity address, as in the stack bond list. */
+    uint16_t         conn_interval;     /**< Connection interval the peer settled on, in 1.25 ms units. */
+    uint16_t         conn_latency;
+    uint32_t         last_used;         /**< LRU stamp, higher is more recent. */
+} user_bond_peer_t;
+
+/*
+ * GLOBAL FUNCTION DECLARATION
+ *****************************************************************************************
+ */
+/**
+ *****************************************************************************************
+ * @brief Load the records and reconcile them with the stack bond list, call after the
+ *        stack is up and user_settings_init().
+ *****************************************************************************************
+ */
+void user_bond_init(void);
+
+/**
+ *****************************************************************************************
+ * @brief Look the peer up once on connect and mark it most recently used.
+ *
+ * @return Settings of the peer, NULL if it is not bonded.
+ *****************************************************************************************
+ */
+user_bond_peer_t *user_bond_connected(uint8_t conn_idx, const ble_gap_bdaddr_t *p_addr);
+
+/**
+ *****************************************************************************************
+ * @brief Settings of the peer on a link, as found by user_bond_connected().
+ *
+ * @return NULL if the peer is not bonded.
+ *****************************************************************************************
+ */
+user_bond_peer_t *user_bond_peer_get(uint8_t conn_idx);
+
+/**
+ *****************************************************************************************
+ * @brief A peer starts pairing. When the stack bond list is full and the peer is new,
+ *        evict the least recently used peer that is not connected.
+ *****************************************************************************************
+ */
+void user_bond_pairing_start(uint8_t conn_idx);
+
+/**
+ *****************************************************************************************
+ * @brief The link is encrypted. A new bond in the stack list gets its record and is
+ *        bound to the link.
+ *****************************************************************************************
+ */
+void user_bond_encrypted(uint8_t conn_idx);
+
+/**
+ *****************************************************************************************
+ * @brief Store the settings of the peer on a link after the caller changed them.
+ *****************************************************************************************
+ */
+void user_bond_peer_save(uint8_t conn_idx);
+
+/**
+ *****************************************************************************************
+ * @brief Unbind the peer from the link.
+ *****************************************************************************************
+ */
+void user_bond_disconnected(uint8_t conn_idx);
+
+#endif
@@ -0,0 +1,95 @@
+/**
+ *****************************************************************************************
+ *
+ * @file user_boot.c
+ *
+ * @brief Boot timeline implementation.
+ *
+ *****************************************************************************************
+ * @attention
+  #####Copyright (c) 2019 GOODIX
+  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of GOODIX nor the names of its contributors may be used
+    to endorse or promote products derived from this software without
+    specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************************
+ */
+/*
+ * INCLUDE FILES
+ *****************************************************************************************
+ */
+#include "user_boot.h"
+#include "user_perf.h"
+#include "app_log.h"
+
+/*
+ * LOCAL VARIABLE DEFINITIONS
+ *****************************************************************************************
+ */
+static const char *const s_boot_stage_name[BOOT_STAGE_NB] =
+{
+    "periph", "mem paint", "stack init", "stack ready", "services", "adv req", "adv started", "deferred",
+};
+static uint32_t s_boot_us[BOOT_STAGE_NB];
+static uint8_t  s_boot_reached;
+
+/*
+ * GLOBAL FUNCTION DEFINITIONS
+ *****************************************************************************************
+ */
+void user_boot_mark(boot_stage_t stage)
+{
+    if (!user_boot_stage_reached(stage))
+    {
+        s_boot_us[stage] = user_perf_now_us();
+        s_boot_reached  |= (1 << stage);
+    }
+}
+
+bool user_boot_stage_reached(boot_stage_t stage)
+{
+    return (s_boot_reached & (1 << stage)) != 0;
+}
+
+uint32_t user_boot_time_us(boot_stage_t stage)
+{
+    return user_boot_stage_reached(stage) ? s_boot_us[stage] : 0;
+}
+
+void user_boot_dump(void)
+{
+    uint32_t prev_us = 0;
+    uint32_t time_us;
+
+    APP_LOG_INFO("Boot timeline (us from main):");
+    for (uint8_t i = 0; i < BOOT_STAGE_NB; i++)
+    {
+        if (!user_boot_stage_reached((boot_stage_t)i))
+        {
+            continue;
+        }
+        time_us = user_boot_time_us((boot_stage_t)i);
+        APP_LOG_INFO("  %-12s %7d  (+%d)", s_boot_stage_name[i], time_us, time_us - prev_us);
+        prev_us = time_us;
+    }
+}
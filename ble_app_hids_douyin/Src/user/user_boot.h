@@ -0,0 +1,97 @@
+/**
+ *****************************************************************************************
+ *
+ * @file user_boot.h
+ *
+ * @brief Boot timeline, cycle stamp of each init stage from main() to the first advertisement.
+ *
+ *****************************************************************************************
+ * @attention
+  #####Copyright (c) 2019 GOODIX
+  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of GOODIX nor the names of its contributors may be used
+    to endorse or promote products derived from this software without
+    specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************************
+ */
+#ifndef __USER_BOOT_H__
+#define __USER_BOOT_H__
+
+/*
+ * INCLUDE FILES
+ *****************************************************************************************
+ */
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * TYPEDEFS
+ *****************************************************************************************
+ */
+/**@brief Boot stages, in boot order. Each one is stamped when it ends. */
+typedef enum
+{
+    BOOT_STAGE_PERIPH,          /**< app_periph_init() done, the counter starts at 0 in main(). */
+    BOOT_STAGE_MEM_PAINT,       /**< Stack and BLE heaps painted. */
+    BOOT_STAGE_STACK_INIT,      /**< ble_stack_init() returned. */
+    BOOT_STAGE_STACK_READY,     /**< BLE_COMMON_EVT_STACK_INIT received. */
+    BOOT_STAGE_SERVICES,        /**< Services, advertising and security set up. */
+    BOOT_STAGE_ADV_REQ,         /**< ble_gap_adv_start() returned. */
+    BOOT_STAGE_ADV_STARTED,     /**< BLE_GAPM_EVT_ADV_START received, first advertisement on air. */
+    BOOT_STAGE_DEFERRED,        /**< Log, LED and banner done after advertising started. */
+    BOOT_STAGE_NB,
+} boot_stage_t;
+
+/*
+ * GLOBAL FUNCTION DECLARATION
+ *****************************************************************************************
+ */
+/**
+ *****************************************************************************************
+ * @brief Stamp the end of a boot stage, only the first call of each stage counts.
+ *****************************************************************************************
+ */
+void user_boot_mark(boot_stage_t stage);
+
+/**
+ *****************************************************************************************
+ * @brief Check whether a boot stage has been stamped.
+ *****************************************************************************************
+ */
+bool user_boot_stage_reached(boot_stage_t stage);
+
+/**
+ *****************************************************************************************
+ * @brief Time from main() to the end of a stage, in us, 0 when not reached yet.
+ *****************************************************************************************
+ */
+uint32_t user_boot_time_us(boot_stage_t stage);
+
+/**
+ *****************************************************************************************
+ * @brief Print the boot timeline, the log must be up.
+ *****************************************************************************************
+ */
+void user_boot_dump(void);
+
+#endif
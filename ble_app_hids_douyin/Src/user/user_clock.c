@@ -0,0 +1,254 @@
+/**
+ *****************************************************************************************
+ *
+ * @file user_clock.c
+ *
+ * @brief System clock governor implementation.
+ *
+ *****************************************************************************************
+ * @attention
+  #####Copyright (c) 2019 GOODIX
+  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of GOODIX nor the names of its contributors may be used
+    to endorse or promote products derived from this software without
+    specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************************
+ */
+/*
+ * INCLUDE FILES
+ *****************************************************************************************
+ */
+#include "user_clock.h"
+#include "user_perf.h"
+#include "user_trace.h"
+#include "board_SK.h"
+#include "app_log.h"
+#include "app_pwr_mgmt.h"
+
+/*
+ * DEFINES
+ *****************************************************************************************
+ */
+/* The UART baud rate divisor follows the core clock, the UART is re-initialized after every
+ * transition. It is not drained first, a log line still in the FIFO is cut short. */
+#define CLOCK_UART_IN_USE   ((APP_LOG_ENABLE && (APP_LOG_PORT == 0)) || \
+                             (USER_TRACE_ENABLE && (USER_TRACE_PORT == USER_TRACE_PORT_UART)))
+
+#define CLOCK_UART_MIN_HZ   (APP_UART_BAUDRATE * 16 * USER_CLOCK_UART_DIV_MIN)
+
+/*
+ * LOCAL VARIABLE DEFINITIONS
+ *****************************************************************************************
+ */
+/**@brief Frequency of each mcu_clock_type_t, in MHz. */
+static const uint8_t s_clock_mhz[] = {64, 32, 16, 16, 8, 2};
+
+static mcu_clock_type_t   s_clock_low;
+static clock_level_t      s_clock_level = CLOCK_LEVEL_HIGH;
+static volatile uint32_t  s_clock_users;            /**< Bit mask of clock_user_t holding the high clock. */
+static volatile bool      s_clock_raise_due;        /**< Requested from an interrupt, switch in the main loop. */
+static volatile uint32_t  s_clock_release_us;       /**< Awake time at the last release. */
+static uint32_t           s_clock_level_us;         /**< Awake time at the last residency update. */
+static user_clock_stats_t s_clock_stats;
+
+/*
+ * LOCAL FUNCTION DEFINITIONS
+ *****************************************************************************************
+ */
+/**@brief Lowest clock that still drives the UART, the XO is preferred over the PLL at 16 MHz. */
+static mcu_clock_type_t clock_low_select(void)
+{
+    mcu_clock_type_t low = USER_CLOCK_HIGH;
+
+    for (uint8_t i = 0; i < sizeof(s_clock_mhz); i++)
+    {
+#if CLOCK_UART_IN_USE
+        if (s_clock_mhz[i] * 1000000u < CLOCK_UART_MIN_HZ)
+        {
+            continue;
+        }
+#endif
+        if (s_clock_mhz[i] < s_clock_mhz[low])
+        {
+            low = (mcu_clock_type_t)i;
+        }
+    }
+    return low;
+}
+
+static void clock_residency_update(void)
+{
+    uint32_t now = user_perf_now_us();
+
+    s_clock_stats.time_us[s_clock_level] += now - s_clock_level_us;
+    s_clock_level_us = now;
+}
+
+/**@brief Switch the core clock, thread mode only. */
+static void clock_level_set(clock_level_t level)
+{
+    uint32_t start;
+    uint32_t us;
+
+    if (level == s_clock_level)
+    {
+        return;
+    }
+
+    clock_residency_update();
+    // Folds the cycles run at the old clock into the us base before the clock changes.
+    start = user_perf_now_us();
+    SystemCoreSetClock(level == CLOCK_LEVEL_HIGH ? USER_CLOCK_HIGH : s_clock_low);
+#if CLOCK_UART_IN_USE
+    bsp_uart_clock_update();
+#endif
+    s_clock_level_us = user_perf_now_us();
+    s_clock_level    = level;
+    us               = s_clock_level_us - start;
+
+    s_clock_stats.switches++;
+    s_clock_stats.switch_us_total += us;
+    if (us > s_clock_stats.switch_us_max)
+    {
+        s_clock_stats.switch_us_max = us;
+    }
+    USER_TRACE(TRACE_ID_CLOCK, SystemCoreClock / 1000000, us);
+}
+
+#if USER_CLOCK_GOVERNOR_ENABLE
+static bool clock_sleep_enter(void)
+{
+    return true;
+}
+
+static void clock_sleep_canceled(void)
+{
+}
+
+/**
+ *****************************************************************************************
+ * @brief The warm boot brings the core back at SYSTEM_CLOCK and the UART drivers re-init
+ *        at that clock. The low level is applied again, then the UART follows it.
+ *****************************************************************************************
+ */
+static void clock_wake_up(void)
+{
+    if (s_clock_level == CLOCK_LEVEL_LOW)
+    {
+        user_perf_now_us();
+        SystemCoreSetClock(s_clock_low);
+#if CLOCK_UART_IN_USE
+        bsp_uart_clock_update();
+#endif
+    }
+}
+
+static const app_sleep_callbacks_t s_clock_sleep_cb =
+{
+    .app_prepare_for_sleep = clock_sleep_enter,
+    .app_sleep_canceled    = clock_sleep_canceled,
+    .app_wake_up_ind       = clock_wake_up,
+};
+#endif
+
+/*
+ * GLOBAL FUNCTION DEFINITIONS
+ *****************************************************************************************
+ */
+void user_clock_init(void)
+{
+#if USER_CLOCK_GOVERNOR_ENABLE
+    s_clock_low      = clock_low_select();
+    s_clock_level_us = user_perf_now_us();
+    // Registered after the drivers, so the UART is re-initialized last on wake up.
+    pwr_register_sleep_cb(&s_clock_sleep_cb, WAPEUP_PRIORITY_LOW);
+    if (s_clock_users == 0)
+    {
+        clock_level_set(CLOCK_LEVEL_LOW);
+    }
+#endif
+}
+
+void user_clock_request(clock_user_t user)
+{
+#if USER_CLOCK_GOVERNOR_ENABLE
+    GLOBAL_EXCEPTION_DISABLE();
+    s_clock_users |= (1 << user);
+    GLOBAL_EXCEPTION_ENABLE();
+
+    if (s_clock_level != CLOCK_LEVEL_HIGH)
+    {
+        s_clock_raise_due = true;
+    }
+#endif
+}
+
+void user_clock_release(clock_user_t user)
+{
+#if USER_CLOCK_GOVERNOR_ENABLE
+    GLOBAL_EXCEPTION_DISABLE();
+    s_clock_users &= ~(1 << user);
+    s_clock_release_us = user_perf_now_us();
+    GLOBAL_EXCEPTION_ENABLE();
+#endif
+}
+
+void user_clock_schedule(void)
+{
+#if USER_CLOCK_GOVERNOR_ENABLE
+    if (s_clock_raise_due)
+    {
+        s_clock_raise_due = false;
+        clock_level_set(CLOCK_LEVEL_HIGH);
+    }
+    else if (s_clock_level == CLOCK_LEVEL_HIGH && s_clock_users == 0 &&
+             (user_perf_now_us() - s_clock_release_us) >= USER_CLOCK_HOLD_MS * 1000)
+    {
+        clock_level_set(CLOCK_LEVEL_LOW);
+        // A request from an interrupt during the switch saw the high level still set.
+        s_clock_raise_due = (s_clock_users != 0);
+    }
+    else
+    {
+        // Folds the cycle counter into the us base well within one counter wrap.
+        clock_residency_update();
+    }
+#endif
+}
+
+void user_clock_stats_get(user_clock_stats_t *p_stats)
+{
+    clock_residency_update();
+    *p_stats = s_clock_stats;
+}
+
+void user_clock_dump(void)
+{
+    user_clock_stats_t stats;
+
+    user_clock_stats_get(&stats);
+    APP_LOG_INFO("Clock: %d switches (max %d us, total %d us), high %d ms, low (%d MHz) %d ms.",
+                 stats.switches, stats.switch_us_max, stats.switch_us_total,
+                 (uint32_t)(stats.time_us[CLOCK_LEVEL_HIGH] / 1000), s_clock_mhz[s_clock_low],
+                 (uint32_t)(stats.time_us[CLOCK_LEVEL_LOW] / 1000));
+}
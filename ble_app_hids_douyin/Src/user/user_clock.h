@@ -0,0 +1,136 @@
+/**
+ *****************************************************************************************
+ *
+ * @file user_clock.h
+ *
+ * @brief System clock governor, high clock while a user holds a request, the lowest usable clock otherwise.
+ *
+ *****************************************************************************************
+ * @attention
+  #####Copyright (c) 2019 GOODIX
+  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of GOODIX nor the names of its contributors may be used
+    to endorse or promote products derived from this software without
+    specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************************
+ */
+#ifndef __USER_CLOCK_H__
+#define __USER_CLOCK_H__
+
+/*
+ * INCLUDE FILES
+ *****************************************************************************************
+ */
+#include "gr_includes.h"
+#include "custom_config.h"
+
+/*
+ * DEFINES
+ *****************************************************************************************
+ */
+#ifndef USER_CLOCK_GOVERNOR_ENABLE
+#define USER_CLOCK_GOVERNOR_ENABLE          1       /**< 0 keeps SYSTEM_CLOCK all the time. */
+#endif
+
+#define USER_CLOCK_HIGH                     ((mcu_clock_type_t)SYSTEM_CLOCK)  /**< Clock while a request is held. */
+#define USER_CLOCK_HOLD_MS                  5       /**< High clock kept after the last release, covers back to back gestures. */
+#define USER_CLOCK_UART_DIV_MIN             4       /**< Lowest UART divisor (clock / 16 / baud) with an acceptable baud error. */
+
+/*
+ * TYPEDEFS
+ *****************************************************************************************
+ */
+/**@brief Users of the high clock. */
+typedef enum
+{
+    CLOCK_USER_GESTURE,         /**< A gesture is playing. */
+    CLOCK_USER_PAIRING,         /**< Pairing and encryption, the P-256 and AES work of the stack. */
+    CLOCK_USER_NB,
+} clock_user_t;
+
+/**@brief Clock levels. */
+typedef enum
+{
+    CLOCK_LEVEL_LOW,
+    CLOCK_LEVEL_HIGH,
+    CLOCK_LEVEL_NB,
+} clock_level_t;
+
+/**@brief Governor statistics, the awake time only, the cycle counter stops in sleep. */
+typedef struct
+{
+    uint32_t switches;                      /**< Clock transitions. */
+    uint32_t switch_us_max;                 /**< Longest transition, PLL lock and UART re-init. */
+    uint32_t switch_us_total;
+    uint64_t time_us[CLOCK_LEVEL_NB];       /**< Time spent at each level. */
+} user_clock_stats_t;
+
+/*
+ * GLOBAL FUNCTION DECLARATION
+ *****************************************************************************************
+ */
+/**
+ *****************************************************************************************
+ * @brief Pick the low clock and drop to it, call after the UART users are set up.
+ *****************************************************************************************
+ */
+void user_clock_init(void);
+
+/**
+ *****************************************************************************************
+ * @brief Hold the high clock. The switch happens in the next user_clock_schedule(), so the
+ *        caller's first report goes out at the current clock. Callable from interrupt context.
+ *****************************************************************************************
+ */
+void user_clock_request(clock_user_t user);
+
+/**
+ *****************************************************************************************
+ * @brief Release the high clock, the low clock comes back USER_CLOCK_HOLD_MS after the
+ *        last user released it.
+ *****************************************************************************************
+ */
+void user_clock_release(clock_user_t user);
+
+/**
+ *****************************************************************************************
+ * @brief Apply pending transitions, call from the main loop before the log is drained.
+ *****************************************************************************************
+ */
+void user_clock_schedule(void);
+
+/**
+ *****************************************************************************************
+ * @brief Get the governor statistics.
+ *****************************************************************************************
+ */
+void user_clock_stats_get(user_clock_stats_t *p_stats);
+
+/**
+ *****************************************************************************************
+ * @brief Print the governor statistics to the log.
+ *****************************************************************************************
+ */
+void user_clock_dump(void);
+
+#endif
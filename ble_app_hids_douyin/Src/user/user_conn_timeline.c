@@ -0,0 +1,122 @@
+/**
+ *****************************************************************************************
+ *
+ * @file user_conn_timeline.c
+ *
+ * @brief Connection setup timeline implementation.
+ *
+ *****************************************************************************************
+ * @attention
+  #####Copyright (c) 2019 GOODIX
+  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of GOODIX nor the names of its contributors may be used
+    to endorse or promote products derived from this software without
+    specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************************
+ */
+/*
+ * INCLUDE FILES
+ *****************************************************************************************
+ */
+#include "user_conn_timeline.h"
+#include "user_perf.h"
+#include "app_log.h"
+#include "custom_config.h"
+#include <string.h>
+
+/*
+ * STRUCT DEFINE
+ *****************************************************************************************
+ */
+/**@brief Timeline of one link. */
+typedef struct
+{
+    uint32_t             conn_us;       /**< Awake time at the connection. */
+    uint16_t             reached;       /**< Bit mask of the stamped conn_phase_t. */
+    user_conn_timeline_t timeline;
+} conn_timeline_env_t;
+
+/*
+ * LOCAL VARIABLE DEFINITIONS
+ *****************************************************************************************
+ */
+static conn_timeline_env_t s_conn_timeline_env[CFG_MAX_CONNECTIONS];
+
+/*
+ * GLOBAL FUNCTION DEFINITIONS
+ *****************************************************************************************
+ */
+void user_conn_timeline_mark(uint8_t conn_idx, conn_phase_t phase, uint16_t status)
+{
+    conn_timeline_env_t *p_env;
+    uint32_t            *p_us;
+
+    if (conn_idx >= CFG_MAX_CONNECTIONS)
+    {
+        return;
+    }
+    p_env = &s_conn_timeline_env[conn_idx];
+
+    if (phase == CONN_PHASE_CONNECTED)
+    {
+        memset(p_env, 0, sizeof(*p_env));
+        p_env->conn_us = user_perf_now_us();
+        p_env->reached = (1 << CONN_PHASE_CONNECTED);
+        return;
+    }
+    if (p_env->reached & (1 << phase))
+    {
+        return;
+    }
+    p_env->reached |= (1 << phase);
+    p_us            = p_env->timeline.phase_us;
+    p_us[phase]     = user_perf_now_us() - p_env->conn_us;
+
+    if (phase == CONN_PHASE_ENCRYPTED)
+    {
+        p_env->timeline.enc_status = status;
+        APP_LOG_INFO("Conn %d setup (us): sec req %d, pair req %d, nc req %d, encrypted %d (0x%x), params %d, os %d.",
+                     conn_idx, p_us[CONN_PHASE_SEC_REQ], p_us[CONN_PHASE_PAIR_REQ], p_us[CONN_PHASE_NC_REQ],
+                     p_us[CONN_PHASE_ENCRYPTED], status, p_us[CONN_PHASE_PARAM_UPDATED], p_us[CONN_PHASE_OS_KNOWN]);
+    }
+    else if (phase == CONN_PHASE_FIRST_REPORT)
+    {
+        if (p_us[phase] > USER_CONN_FIRST_REPORT_BUDGET_MS * 1000)
+        {
+            APP_LOG_WARNING("Conn %d first report after %d us, over the %d ms budget.",
+                            conn_idx, p_us[phase], USER_CONN_FIRST_REPORT_BUDGET_MS);
+        }
+        else
+        {
+            APP_LOG_INFO("Conn %d first report after %d us.", conn_idx, p_us[phase]);
+        }
+    }
+}
+
+void user_conn_timeline_get(uint8_t conn_idx, user_conn_timeline_t *p_timeline)
+{
+    if (conn_idx < CFG_MAX_CONNECTIONS)
+    {
+        *p_timeline = s_conn_timeline_env[conn_idx].timeline;
+    }
+}
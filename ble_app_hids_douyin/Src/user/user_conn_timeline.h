@@ -0,0 +1,100 @@
+/**
+ *****************************************************************************************
+ *
+ * @file user_conn_timeline.h
+ *
+ * @brief Connection setup timeline, from the connection to the first input report.
+ *
+ *****************************************************************************************
+ * @attention
+  #####Copyright (c) 2019 GOODIX
+  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of GOODIX nor the names of its contributors may be used
+    to endorse or promote products derived from this software without
+    specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************************
+ */
+#ifndef __USER_CONN_TIMELINE_H__
+#define __USER_CONN_TIMELINE_H__
+
+/*
+ * INCLUDE FILES
+ *****************************************************************************************
+ */
+#include "gr_includes.h"
+
+/*
+ * DEFINES
+ *****************************************************************************************
+ */
+#define USER_CONN_FIRST_REPORT_BUDGET_MS    1000    /**< Connect to first report budget, a warning is logged above it. */
+
+/*
+ * TYPEDEFS
+ *****************************************************************************************
+ */
+/**@brief Setup phases, each one is stamped the first time it is reached on a link. */
+typedef enum
+{
+    CONN_PHASE_CONNECTED,       /**< Link up, restarts the timeline. */
+    CONN_PHASE_SEC_REQ,         /**< Security request sent to a bonded peer. */
+    CONN_PHASE_PAIR_REQ,        /**< BLE_SEC_PAIR_REQ from the stack, features exchanged. */
+    CONN_PHASE_NC_REQ,          /**< BLE_SEC_NC_REQ, LESC public keys exchanged and DHKey computed. */
+    CONN_PHASE_ENCRYPTED,       /**< BLE_SEC_EVT_LINK_ENCRYPTED, success or failure. */
+    CONN_PHASE_PARAM_UPDATED,   /**< First BLE_GAPC_EVT_CONN_PARAM_UPDATED. */
+    CONN_PHASE_OS_KNOWN,        /**< Peer OS known, from the cache or the ANCS browse. */
+    CONN_PHASE_FIRST_REPORT,    /**< First input report queued. */
+    CONN_PHASE_NB,
+} conn_phase_t;
+
+/**@brief Timeline of one link, in us from the connection, 0 when a phase was not reached. */
+typedef struct
+{
+    uint32_t phase_us[CONN_PHASE_NB];
+    uint16_t enc_status;        /**< evt_status of BLE_SEC_EVT_LINK_ENCRYPTED. */
+} user_conn_timeline_t;
+
+/*
+ * GLOBAL FUNCTION DECLARATION
+ *****************************************************************************************
+ */
+/**
+ *****************************************************************************************
+ * @brief Stamp a setup phase. The timeline is logged once the link is encrypted, the
+ *        first report is logged against USER_CONN_FIRST_REPORT_BUDGET_MS.
+ *
+ * @param[in] conn_idx: Connection index.
+ * @param[in] phase:    Phase reached.
+ * @param[in] status:   Encryption status, only used with CONN_PHASE_ENCRYPTED.
+ *****************************************************************************************
+ */
+void user_conn_timeline_mark(uint8_t conn_idx, conn_phase_t phase, uint16_t status);
+
+/**
+ *****************************************************************************************
+ * @brief Get the timeline of a link, valid until the next connection on that index.
+ *****************************************************************************************
+ */
+void user_conn_timeline_get(uint8_t conn_idx, user_conn_timeline_t *p_timeline);
+
+#endif
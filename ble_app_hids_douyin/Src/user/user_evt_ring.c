@@ -0,0 +1,103 @@
+/**
+ *****************************************************************************************
+ *
+ * @file user_evt_ring.c
+ *
+ * @brief Lock-free input event ring implementation.
+ *
+ *****************************************************************************************
+ * @attention
+  #####Copyright (c) 2019 GOODIX
+  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of GOODIX nor the names of its contributors may be used
+    to endorse or promote products derived from this software without
+    specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************************
+ */
+/*
+ * INCLUDE FILES
+ *****************************************************************************************
+ */
+#include "user_evt_ring.h"
+
+/*
+ * GLOBAL FUNCTION DEFINITIONS
+ *****************************************************************************************
+ */
+bool user_evt_ring_push(user_evt_ring_t *p_ring, const user_evt_t *p_evt)
+{
+    uint32_t    head;
+    uint32_t    dropped;
+    user_evt_t *p_slot;
+
+    do
+    {
+        head = __LDREXW(&p_ring->head);
+        if ((head - p_ring->tail) >= USER_EVT_RING_SIZE)
+        {
+            __CLREX();
+            do
+            {
+                dropped = __LDREXW(&p_ring->dropped);
+            } while (__STREXW(dropped + 1, &p_ring->dropped));
+            return false;
+        }
+    } while (__STREXW(head + 1, &p_ring->head));
+
+    p_slot             = &p_ring->buf[head & USER_EVT_RING_MASK];
+    p_slot->timestamp  = p_evt->timestamp;
+    p_slot->type       = p_evt->type;
+    p_slot->key_id     = p_evt->key_id;
+    p_slot->click_type = p_evt->click_type;
+    __DMB();
+    p_slot->ready      = 1;
+
+    return true;
+}
+
+bool user_evt_ring_pop(user_evt_ring_t *p_ring, user_evt_t *p_evt)
+{
+    uint32_t    tail = p_ring->tail;
+    user_evt_t *p_slot;
+
+    if (tail == p_ring->head)
+    {
+        return false;
+    }
+
+    p_slot = &p_ring->buf[tail & USER_EVT_RING_MASK];
+    if (!p_slot->ready)
+    {
+        return false;
+    }
+    __DMB();
+    p_evt->timestamp  = p_slot->timestamp;
+    p_evt->type       = p_slot->type;
+    p_evt->key_id     = p_slot->key_id;
+    p_evt->click_type = p_slot->click_type;
+    p_slot->ready     = 0;
+    __DMB();
+    p_ring->tail      = tail + 1;
+
+    return true;
+}
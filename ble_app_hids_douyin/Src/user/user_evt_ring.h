@@ -0,0 +1,121 @@
+/**
+ *****************************************************************************************
+ *
+ * @file user_evt_ring.h
+ *
+ * @brief Lock-free input event ring between interrupt context and the main loop.
+ *
+ *****************************************************************************************
+ * @attention
+  #####Copyright (c) 2019 GOODIX
+  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of GOODIX nor the names of its contributors may be used
+    to endorse or promote products derived from this software without
+    specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************************
+ */
+#ifndef __USER_EVT_RING_H__
+#define __USER_EVT_RING_H__
+
+/*
+ * INCLUDE FILES
+ *****************************************************************************************
+ */
+#include "gr_includes.h"
+
+/*
+ * DEFINES
+ *****************************************************************************************
+ */
+#define USER_EVT_RING_SIZE          16                      /**< Must be a power of 2. */
+#define USER_EVT_RING_MASK          (USER_EVT_RING_SIZE - 1)
+
+#if (USER_EVT_RING_SIZE & USER_EVT_RING_MASK)
+#error "USER_EVT_RING_SIZE must be a power of 2"
+#endif
+
+/*
+ * TYPEDEFS
+ *****************************************************************************************
+ */
+/**@brief Input event types. */
+typedef enum
+{
+    USER_EVT_KEY_DOWN,          /**< Zero-wait key pressed. */
+    USER_EVT_KEY_UP,            /**< Zero-wait key released. */
+    USER_EVT_KEY_CLICK,         /**< app_key click, see click_type. */
+} user_evt_type_t;
+
+/**@brief Input event. */
+typedef struct
+{
+    uint32_t         timestamp;     /**< user_perf_now_us() when the event happened. */
+    uint8_t          type;          /**< See @ref user_evt_type_t. */
+    uint8_t          key_id;
+    uint8_t          click_type;    /**< app_key_click_type_t of USER_EVT_KEY_CLICK. */
+    volatile uint8_t ready;         /**< Set by the producer once the slot is written, internal. */
+} user_evt_t;
+
+/**@brief Event ring, zero initialized is empty. */
+typedef struct
+{
+    volatile uint32_t head;         /**< Next slot to claim, advanced by producers. */
+    volatile uint32_t tail;         /**< Next slot to read, advanced by the consumer only. */
+    volatile uint32_t dropped;      /**< Events lost because the ring was full. */
+    user_evt_t        buf[USER_EVT_RING_SIZE];
+} user_evt_ring_t;
+
+/*
+ * GLOBAL FUNCTION DECLARATION
+ *****************************************************************************************
+ */
+/**
+ *****************************************************************************************
+ * @brief Push an event, callable from any interrupt context.
+ *
+ * @details A slot is claimed with LDREX/STREX, so producers preempting each other (GPIO
+ *          interrupt, timer callback) never share a slot. The slot is published with a
+ *          ready flag after a memory barrier.
+ *
+ * @param[in] p_ring: Event ring.
+ * @param[in] p_evt:  Event to push, its ready field is ignored.
+ *
+ * @return true on success, false if the ring is full and the event was dropped.
+ *****************************************************************************************
+ */
+bool user_evt_ring_push(user_evt_ring_t *p_ring, const user_evt_t *p_evt);
+
+/**
+ *****************************************************************************************
+ * @brief Pop the oldest event, main loop only.
+ *
+ * @param[in]  p_ring: Event ring.
+ * @param[out] p_evt:  Popped event.
+ *
+ * @return true if an event was popped, false if the ring is empty or the oldest slot is
+ *         still being written by an interrupted producer.
+ *****************************************************************************************
+ */
+bool user_evt_ring_pop(user_evt_ring_t *p_ring, user_evt_t *p_evt);
+
+#endif
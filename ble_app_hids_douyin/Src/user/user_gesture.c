@@ -0,0 +1,801 @@
+/**
+ *****************************************************************************************
+ *
+ * @file user_gesture.c
+ *
+ * @brief Non-blocking, preemptible gesture engine implementation.
+ *
+ *****************************************************************************************
+ * @attention
+  #####Copyright (c) 2019 GOODIX
+  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of GOODIX nor the names of its contributors may be used
+    to endorse or promote products derived from this software without
+    specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************************
+ */
+/*
+ * INCLUDE FILES
+ *****************************************************************************************
+ */
+#include "user_gesture.h"
+#include "user_mouse.h"
+#include "user_trajectory.h"
+#include "user_trace.h"
+#include "user_perf.h"
+#include "user_clock.h"
+#include "app_timer.h"
+#include "app_log.h"
+#include "app_error.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * DEFINES
+ *****************************************************************************************
+ */
+#define GESTURE_STEP_DONE                   0             /**< Returned by a step function once the gesture is complete. */
+#define GESTURE_FRAME                       DELAY_FOR_EVERY_ACTION /**< One connection event. */
+
+#define GESTURE_PRIO_LOW                    0
+#define GESTURE_PRIO_MID                    1
+#define GESTURE_PRIO_HIGH                   2
+
+/**@brief Every gesture type needs its own profile site. */
+typedef char gesture_profile_site_check_t[(GESTURE_MAX <= USER_PROFILE_GESTURE_NB) ? 1 : -1];
+
+#define GESTURE_REPEAT_INTERVAL_MS          400           /**< Interval between the first two auto-repeat gestures. */
+#define GESTURE_REPEAT_ACCEL_PERCENT        80            /**< Each repeat interval is this percentage of the previous one. */
+#define GESTURE_REPEAT_INTERVAL_MIN_MS      (GESTURE_FRAME * 2) /**< Fastest repeat, gestures longer than this play back to back. */
+
+#define GESTURE_FINGER_MOVE_FRAMES          5             /**< Move frames of a linear multi-finger move, velocity comes from the scan time. */
+#define GESTURE_FLING_EXIT_SPEED            32000         /**< Finger velocity at lift of a swipe, in logical units per second. */
+#define GESTURE_WHEEL_SWIPE_DELTA           360           /**< Wheel travel of one feed swipe, in detent (low resolution) units. */
+#define GESTURE_PAN_SWIPE_DELTA             360           /**< AC Pan travel of one horizontal swipe, in detent (low resolution) units. */
+#define GESTURE_FINGER_CENTER_X             2048          /**< Screen center, in finger logical units. */
+#define GESTURE_FINGER_CENTER_Y             2048
+#define GESTURE_FINGER_SWIPE_X              1904          /**< Vertical swipes run along this X position. */
+#define GESTURE_FINGER_SWIPE_TOP_Y          500
+#define GESTURE_FINGER_SWIPE_BOTTOM_Y       3200
+#define GESTURE_FINGER_SWIPE_DOWN_Y         1012          /**< Start of the down swipe, below the top bar. */
+#define GESTURE_FINGER_SWIPE_LEFT_X         3200          /**< Horizontal swipes run between these two X positions. */
+#define GESTURE_FINGER_SWIPE_RIGHT_X        800
+#define GESTURE_FINGER_LIKE_X               1904          /**< Double tap position, in finger logical units. */
+#define GESTURE_FINGER_LIKE_Y               2024
+#define GESTURE_PINCH_NEAR_OFFSET           200           /**< Distance of each finger to the pinch center when fingers are close. */
+#define GESTURE_PINCH_FAR_OFFSET            1200          /**< Distance of each finger to the pinch center when fingers are apart. */
+#define GESTURE_CONTACTS_MAX                2             /**< Most fingers down at once, reported to the host as Contact Count Maximum. */
+#define GESTURE_POINTER_SWIPE_X             80            /**< Swipe start, relative to the pointer home corner. */
+#define GESTURE_POINTER_SWIPE_Y             (-120)
+#define GESTURE_POINTER_LIKE_X              120           /**< Double tap position, relative to the pointer home corner. */
+#define GESTURE_POINTER_LIKE_Y              (-360)
+
+/*
+ * STRUCT DEFINE
+ *****************************************************************************************
+ */
+/**@brief State of the running gesture. */
+typedef struct
+{
+    gesture_type_t   type;
+    bool             is_ios;
+    uint8_t          conn_idx;
+    uint8_t          step;                                  /**< Step counter, owned by the step function. */
+    uint16_t         scan_time;                             /**< Scan time of the last finger frame. */
+    bool             releasing;                             /**< Releasing what is held on the host before the first step or after the last. */
+    bool             done;                                  /**< The last step ran, only the release is left. */
+    bool             horizontal;                            /**< Major axis of a finger swipe. */
+    uint8_t          resend_num;                            /**< Contacts of a refused finger frame, sent again before the next step. */
+    uint32_t         resend_delay;                          /**< Delay the step returned with the refused frame. */
+    trajectory_t     traj;
+    finger_contact_t contacts[HID_FINGER_CONTACT_MAX];
+} gesture_t;
+
+/**@brief Gesture waiting for the running one to complete. */
+typedef struct
+{
+    gesture_type_t type;
+    bool           is_ios;
+    uint8_t        conn_idx;
+} gesture_pending_t;
+
+/**@brief Auto-repeat state. */
+typedef struct
+{
+    gesture_type_t       type;                              /**< GESTURE_NONE when auto-repeat is off. */
+    bool                 is_ios;
+    uint8_t              conn_idx;
+    gesture_hold_check_t hold_check;
+    uint8_t              hold_arg;
+    uint32_t             interval;                          /**< Current repeat interval in ms. */
+} gesture_repeat_t;
+
+/**@brief Step function, plays one frame and returns the delay to the next one in ms, or GESTURE_STEP_DONE. */
+typedef uint32_t (*gesture_step_t)(gesture_t *p_gesture);
+
+/**@brief Gesture table entry. */
+typedef struct
+{
+    gesture_step_t step;
+    uint8_t        priority;
+} gesture_desc_t;
+
+/*
+ * LOCAL FUNCTION DECLARATION
+ *****************************************************************************************
+ */
+static uint32_t gesture_up_step(gesture_t *p_gesture);
+static uint32_t gesture_down_step(gesture_t *p_gesture);
+static uint32_t gesture_left_step(gesture_t *p_gesture);
+static uint32_t gesture_right_step(gesture_t *p_gesture);
+static uint32_t gesture_double_step(gesture_t *p_gesture);
+static uint32_t gesture_func_step(gesture_t *p_gesture);
+static uint32_t gesture_camera_step(gesture_t *p_gesture);
+static uint32_t gesture_pinch_in_step(gesture_t *p_gesture);
+static uint32_t gesture_pinch_out_step(gesture_t *p_gesture);
+
+/*
+ * LOCAL VARIABLE DEFINITIONS
+ *****************************************************************************************
+ */
+static const gesture_desc_t s_gesture_desc[GESTURE_MAX] =
+{
+    [GESTURE_UP]        = {gesture_up_step,        GESTURE_PRIO_LOW},
+    [GESTURE_DOWN]      = {gesture_down_step,      GESTURE_PRIO_LOW},
+    [GESTURE_LEFT]      = {gesture_left_step,      GESTURE_PRIO_LOW},
+    [GESTURE_RIGHT]     = {gesture_right_step,     GESTURE_PRIO_LOW},
+    [GESTURE_DOUBLE]    = {gesture_double_step,    GESTURE_PRIO_MID},
+    [GESTURE_FUNC]      = {gesture_func_step,      GESTURE_PRIO_LOW},
+    [GESTURE_CAMERA]    = {gesture_camera_step,    GESTURE_PRIO_HIGH},
+    [GESTURE_PINCH_IN]  = {gesture_pinch_in_step,  GESTURE_PRIO_LOW},
+    [GESTURE_PINCH_OUT] = {gesture_pinch_out_step, GESTURE_PRIO_LOW},
+};
+
+static app_timer_id_t     s_gesture_timer_id;
+static volatile bool      s_gesture_step_due = false;
+static gesture_t          s_gesture;
+static gesture_pending_t  s_gesture_pending;
+static app_timer_id_t     s_repeat_timer_id;
+static volatile bool      s_repeat_due = false;
+static gesture_repeat_t   s_repeat;
+
+/*
+ * LOCAL FUNCTION DEFINITIONS
+ *****************************************************************************************
+ */
+/**
+ *****************************************************************************************
+ * @brief Send a frame of the first num contacts of the gesture. A frame refused by the
+ *        stack is sent again by gesture_step_run() before the step function runs again,
+ *        the contacts keep their previous state until then.
+ *****************************************************************************************
+ */
+static void gesture_finger_frame_send(gesture_t *p_gesture, uint8_t num)
+{
+    sdk_err_t err_code = user_finger_frame_send(p_gesture->conn_idx, p_gesture->contacts, num, p_gesture->scan_time);
+
+    p_gesture->resend_num = (SDK_ERR_NO_RESOURCES == err_code) ? num : 0;
+}
+
+/**
+ *****************************************************************************************
+ * @brief Scroll on iOS: bring the pointer on the feed, then one wheel/AC Pan report. The
+ *        report is the whole swipe, a refused one is sent again on the next step.
+ *****************************************************************************************
+ */
+static uint32_t gesture_scroll_step(gesture_t *p_gesture, int16_t wheel, int16_t pan)
+{
+    if (user_mouse_pointer_step(p_gesture->conn_idx, GESTURE_POINTER_SWIPE_X, GESTURE_POINTER_SWIPE_Y))
+    {
+        return GESTURE_FRAME;
+    }
+    if (SDK_ERR_NO_RESOURCES == user_mouse_scroll_send(p_gesture->conn_idx, wheel, pan))
+    {
+        return GESTURE_FRAME;
+    }
+
+    return GESTURE_STEP_DONE;
+}
+
+/**
+ *****************************************************************************************
+ * @brief Swipe one finger on Android, accelerating along the major axis then flinging at
+ *        GESTURE_FLING_EXIT_SPEED, the minor axis follows linearly.
+ *****************************************************************************************
+ */
+static uint32_t gesture_swipe_step(gesture_t *p_gesture, uint16_t x_start, uint16_t y_start, uint16_t x_end, uint16_t y_end)
+{
+    finger_contact_t *p_contact = &p_gesture->contacts[0];
+    int32_t           major;
+    int32_t           minor;
+
+    if (p_gesture->step == 0)
+    {
+        p_gesture->horizontal = abs(x_end - x_start) > abs(y_end - y_start);
+        if (p_gesture->horizontal)
+        {
+            trajectory_init(&p_gesture->traj, x_start, x_end, GESTURE_FLING_EXIT_SPEED, GESTURE_FRAME);
+        }
+        else
+        {
+            trajectory_init(&p_gesture->traj, y_start, y_end, GESTURE_FLING_EXIT_SPEED, GESTURE_FRAME);
+        }
+        if (SDK_SUCCESS != user_finger_contact_down(p_contact, x_start, y_start))
+        {
+            return GESTURE_STEP_DONE;
+        }
+        gesture_finger_frame_send(p_gesture, 1);
+        p_gesture->step++;
+        return GESTURE_FRAME;
+    }
+
+    p_gesture->scan_time += HID_SCAN_TIME_PER_FRAME;
+    if (trajectory_next(&p_gesture->traj, &major))
+    {
+        if (p_gesture->horizontal)
+        {
+            minor               = y_start + ((int32_t)y_end - y_start) * p_gesture->traj.frame / p_gesture->traj.frame_count;
+            p_contact->x_data   = (uint16_t)major;
+            p_contact->y_data   = (uint16_t)minor;
+        }
+        else
+        {
+            minor               = x_start + ((int32_t)x_end - x_start) * p_gesture->traj.frame / p_gesture->traj.frame_count;
+            p_contact->x_data   = (uint16_t)minor;
+            p_contact->y_data   = (uint16_t)major;
+        }
+        gesture_finger_frame_send(p_gesture, 1);
+        return GESTURE_FRAME;
+    }
+
+    // Lift at the last position so the host's velocity tracker keeps the exit velocity.
+    user_finger_contact_up(p_contact);
+    gesture_finger_frame_send(p_gesture, 1);
+
+    return GESTURE_STEP_DONE;
+}
+
+/**
+ *****************************************************************************************
+ * @brief Put one finger down or lift it again on Android.
+ *
+ * @return false if no contact ID was free, nothing was sent.
+ *****************************************************************************************
+ */
+static bool gesture_tap_frame(gesture_t *p_gesture, uint16_t x, uint16_t y, bool down)
+{
+    if (down)
+    {
+        if (SDK_SUCCESS != user_finger_contact_down(&p_gesture->contacts[0], x, y))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        user_finger_contact_up(&p_gesture->contacts[0]);
+    }
+    gesture_finger_frame_send(p_gesture, 1);
+
+    return true;
+}
+
+static uint32_t gesture_up_step(gesture_t *p_gesture)
+{
+    if (p_gesture->is_ios)
+    {
+        return gesture_scroll_step(p_gesture, GESTURE_WHEEL_SWIPE_DELTA, 0);
+    }
+    return gesture_swipe_step(p_gesture, GESTURE_FINGER_SWIPE_X, GESTURE_FINGER_SWIPE_BOTTOM_Y,
+                              GESTURE_FINGER_SWIPE_X, GESTURE_FINGER_SWIPE_TOP_Y);
+}
+
+static uint32_t gesture_down_step(gesture_t *p_gesture)
+{
+    if (p_gesture->is_ios)
+    {
+        return gesture_scroll_step(p_gesture, -GESTURE_WHEEL_SWIPE_DELTA, 0);
+    }
+    return gesture_swipe_step(p_gesture, GESTURE_FINGER_SWIPE_X, GESTURE_FINGER_SWIPE_DOWN_Y,
+                              GESTURE_FINGER_SWIPE_X, GESTURE_FINGER_SWIPE_BOTTOM_Y);
+}
+
+static uint32_t gesture_left_step(gesture_t *p_gesture)
+{
+    if (p_gesture->is_ios)
+    {
+        // Same direction convention as the wheel in gesture_up_step: content follows the report sign.
+        return gesture_scroll_step(p_gesture, 0, -GESTURE_PAN_SWIPE_DELTA);
+    }
+    return gesture_swipe_step(p_gesture, GESTURE_FINGER_SWIPE_LEFT_X, GESTURE_FINGER_CENTER_Y,
+                              GESTURE_FINGER_SWIPE_RIGHT_X, GESTURE_FINGER_CENTER_Y);
+}
+
+static uint32_t gesture_right_step(gesture_t *p_gesture)
+{
+    if (p_gesture->is_ios)
+    {
+        return gesture_scroll_step(p_gesture, 0, GESTURE_PAN_SWIPE_DELTA);
+    }
+    return gesture_swipe_step(p_gesture, GESTURE_FINGER_SWIPE_RIGHT_X, GESTURE_FINGER_CENTER_Y,
+                              GESTURE_FINGER_SWIPE_LEFT_X, GESTURE_FINGER_CENTER_Y);
+}
+
+static uint32_t gesture_double_step(gesture_t *p_gesture)
+{
+    if (p_gesture->is_ios)
+    {
+        switch (p_gesture->step)
+        {
+            case 0:
+                if (user_mouse_pointer_step(p_gesture->conn_idx, GESTURE_POINTER_LIKE_X, GESTURE_POINTER_LIKE_Y))
+                {
+                    return GESTURE_FRAME;
+                }
+                p_gesture->step++;
+                return GESTURE_FRAME * 5;
+
+            case 1:
+            case 3:
+                if (SDK_ERR_NO_RESOURCES == user_mouse_button_send(p_gesture->conn_idx, true))
+                {
+                    return GESTURE_FRAME;
+                }
+                p_gesture->step++;
+                return GESTURE_FRAME;
+
+            case 2:
+                if (SDK_ERR_NO_RESOURCES == user_mouse_button_send(p_gesture->conn_idx, false))
+                {
+                    return GESTURE_FRAME;
+                }
+                p_gesture->step++;
+                return GESTURE_FRAME * 4;
+
+            default:
+                if (SDK_ERR_NO_RESOURCES == user_mouse_button_send(p_gesture->conn_idx, false))
+                {
+                    return GESTURE_FRAME;
+                }
+                return GESTURE_STEP_DONE;
+        }
+    }
+
+    switch (p_gesture->step)
+    {
+        case 0:
+            if (!gesture_tap_frame(p_gesture, GESTURE_FINGER_LIKE_X, GESTURE_FINGER_LIKE_Y, true))
+            {
+                return GESTURE_STEP_DONE;
+            }
+            p_gesture->step++;
+            return GESTURE_FRAME;
+
+        case 1:
+            p_gesture->scan_time += HID_SCAN_TIME_PER_FRAME;
+            gesture_tap_frame(p_gesture, GESTURE_FINGER_LIKE_X, GESTURE_FINGER_LIKE_Y, false);
+            p_gesture->step++;
+            return GESTURE_FRAME * 4;
+
+        case 2:
+            p_gesture->scan_time += HID_SCAN_TIME_PER_FRAME * 4;
+            if (!gesture_tap_frame(p_gesture, GESTURE_FINGER_LIKE_X, GESTURE_FINGER_LIKE_Y, true))
+            {
+                return GESTURE_STEP_DONE;
+            }
+            p_gesture->step++;
+            return GESTURE_FRAME;
+
+        default:
+            p_gesture->scan_time += HID_SCAN_TIME_PER_FRAME;
+            gesture_tap_frame(p_gesture, GESTURE_FINGER_LIKE_X, GESTURE_FINGER_LIKE_Y, false);
+            return GESTURE_STEP_DONE;
+    }
+}
+
+static uint32_t gesture_func_step(gesture_t *p_gesture)
+{
+    if (p_gesture->is_ios)
+    {
+        // A single click on the video toggles play/pause.
+        if (p_gesture->step == 0)
+        {
+            if (user_mouse_pointer_step(p_gesture->conn_idx, GESTURE_POINTER_LIKE_X, GESTURE_POINTER_LIKE_Y))
+            {
+                return GESTURE_FRAME;
+            }
+            if (SDK_ERR_NO_RESOURCES == user_mouse_button_send(p_gesture->conn_idx, true))
+            {
+                return GESTURE_FRAME;
+            }
+            p_gesture->step++;
+            return GESTURE_FRAME;
+        }
+        if (SDK_ERR_NO_RESOURCES == user_mouse_button_send(p_gesture->conn_idx, false))
+        {
+            return GESTURE_FRAME;
+        }
+        return GESTURE_STEP_DONE;
+    }
+
+    if (p_gesture->step == 0)
+    {
+        if (!gesture_tap_frame(p_gesture, GESTURE_FINGER_CENTER_X, GESTURE_FINGER_CENTER_Y, true))
+        {
+            return GESTURE_STEP_DONE;
+        }
+        p_gesture->step++;
+        return GESTURE_FRAME;
+    }
+    p_gesture->scan_time += HID_SCAN_TIME_PER_FRAME;
+    gesture_tap_frame(p_gesture, GESTURE_FINGER_CENTER_X, GESTURE_FINGER_CENTER_Y, false);
+
+    return GESTURE_STEP_DONE;
+}
+
+static uint32_t gesture_camera_step(gesture_t *p_gesture)
+{
+    // The camera app takes the shot on the Volume Increment press, the release only ends the key.
+    if (p_gesture->step == 0)
+    {
+        if (SDK_ERR_NO_RESOURCES == user_mouse_volume_send(p_gesture->conn_idx, true))
+        {
+            return GESTURE_FRAME;
+        }
+        p_gesture->step++;
+        return GESTURE_FRAME;
+    }
+    if (SDK_ERR_NO_RESOURCES == user_mouse_volume_send(p_gesture->conn_idx, false))
+    {
+        return GESTURE_FRAME;
+    }
+
+    return GESTURE_STEP_DONE;
+}
+
+/**
+ *****************************************************************************************
+ * @brief Pinch two fingers symmetrically around the screen center. Both fingers land,
+ *        move and lift in the same frame, so the host sees a single two-finger frame each time.
+ *****************************************************************************************
+ */
+static uint32_t gesture_pinch_step(gesture_t *p_gesture, int32_t from, int32_t to)
+{
+    finger_contact_t *p_contacts = p_gesture->contacts;
+    int32_t           offset;
+
+    if (p_gesture->step == 0)
+    {
+        if (SDK_SUCCESS != user_finger_contact_down(&p_contacts[0], GESTURE_FINGER_CENTER_X - from, GESTURE_FINGER_CENTER_Y))
+        {
+            return GESTURE_STEP_DONE;
+        }
+        if (SDK_SUCCESS != user_finger_contact_down(&p_contacts[1], GESTURE_FINGER_CENTER_X + from, GESTURE_FINGER_CENTER_Y))
+        {
+            user_finger_contact_cancel(&p_contacts[0]);
+            return GESTURE_STEP_DONE;
+        }
+        gesture_finger_frame_send(p_gesture, 2);
+        p_gesture->step++;
+        return GESTURE_FRAME;
+    }
+
+    p_gesture->scan_time += HID_SCAN_TIME_PER_FRAME;
+    if (p_gesture->step <= GESTURE_FINGER_MOVE_FRAMES)
+    {
+        offset               = from + (to - from) * p_gesture->step / GESTURE_FINGER_MOVE_FRAMES;
+        p_contacts[0].x_data = GESTURE_FINGER_CENTER_X - offset;
+        p_contacts[1].x_data = GESTURE_FINGER_CENTER_X + offset;
+        gesture_finger_frame_send(p_gesture, 2);
+        p_gesture->step++;
+        return GESTURE_FRAME;
+    }
+
+    user_finger_contact_up(&p_contacts[0]);
+    user_finger_contact_up(&p_contacts[1]);
+    gesture_finger_frame_send(p_gesture, 2);
+
+    return GESTURE_STEP_DONE;
+}
+
+static uint32_t gesture_pinch_in_step(gesture_t *p_gesture)
+{
+    return gesture_pinch_step(p_gesture, GESTURE_PINCH_NEAR_OFFSET, GESTURE_PINCH_FAR_OFFSET);
+}
+
+static uint32_t gesture_pinch_out_step(gesture_t *p_gesture)
+{
+    return gesture_pinch_step(p_gesture, GESTURE_PINCH_FAR_OFFSET, GESTURE_PINCH_NEAR_OFFSET);
+}
+
+static void gesture_timer_handler(void *p_arg)
+{
+    s_gesture_step_due = true;
+}
+
+static void repeat_timer_handler(void *p_arg)
+{
+    s_repeat_due = true;
+}
+
+/**
+ *****************************************************************************************
+ * @brief Make a gesture the running one, its first step runs on the next schedule.
+ *****************************************************************************************
+ */
+static void gesture_begin(uint8_t conn_idx, gesture_type_t type, bool is_ios)
+{
+    memset(&s_gesture, 0, sizeof(s_gesture));
+    s_gesture.type     = type;
+    s_gesture.is_ios   = is_ios;
+    s_gesture.conn_idx = conn_idx;
+    // What a preempted gesture left held is released before the first step.
+    s_gesture.releasing = user_mouse_is_held();
+    user_clock_request(CLOCK_USER_GESTURE);
+    APP_LOG_DEBUG("Gesture %d start, iOS: %d", type, is_ios);
+}
+
+/**
+ *****************************************************************************************
+ * @brief Release what is held on the host, lifts and releases refused by the stack are
+ *        retried every frame until all are queued.
+ *
+ * @return Delay to the next frame, GESTURE_STEP_DONE once nothing is held and nothing
+ *         was sent.
+ *****************************************************************************************
+ */
+static uint32_t gesture_release_step(void)
+{
+    bool sent = user_mouse_release_all(s_gesture.conn_idx);
+
+    s_gesture.releasing = user_mouse_is_held();
+    if (s_gesture.releasing || (sent && !s_gesture.done))
+    {
+        // The first step follows the release one frame later.
+        return GESTURE_FRAME;
+    }
+    return GESTURE_STEP_DONE;
+}
+
+/**
+ *****************************************************************************************
+ * @brief Run one step of the running gesture and arm the timer for the next one. When
+ *        the gesture completes, the pending one (if any) starts right away.
+ *****************************************************************************************
+ */
+USER_RAM_CODE static void gesture_step_run(void)
+{
+    uint32_t delay;
+
+    while (s_gesture.type != GESTURE_NONE)
+    {
+        if (s_gesture.releasing)
+        {
+            delay = gesture_release_step();
+            if (delay == GESTURE_STEP_DONE && !s_gesture.done)
+            {
+                continue;
+            }
+        }
+        else
+        {
+            USER_PROFILE_START(start);
+            USER_TRACE(TRACE_ID_GESTURE_BEGIN, s_gesture.type, 0);
+            if (s_gesture.resend_num)
+            {
+                // The step stays where it is until its refused frame goes out.
+                gesture_finger_frame_send(&s_gesture, s_gesture.resend_num);
+                delay = s_gesture.resend_num ? GESTURE_FRAME : s_gesture.resend_delay;
+            }
+            else
+            {
+                delay = s_gesture_desc[s_gesture.type].step(&s_gesture);
+                if (s_gesture.resend_num)
+                {
+                    s_gesture.resend_delay = delay;
+                    delay                  = GESTURE_FRAME;
+                }
+            }
+            USER_TRACE(TRACE_ID_GESTURE_END, s_gesture.type, delay);
+            USER_PROFILE_STOP(PROFILE_SITE_GESTURE_STEP + s_gesture.type, start);
+            if (delay == GESTURE_STEP_DONE && user_mouse_is_held())
+            {
+                // The last lift or release was refused, keep the gesture until it goes out.
+                s_gesture.done      = true;
+                s_gesture.releasing = true;
+                delay               = GESTURE_FRAME;
+            }
+        }
+        if (delay != GESTURE_STEP_DONE)
+        {
+            app_timer_start(s_gesture_timer_id, delay, NULL);
+            return;
+        }
+
+        s_gesture.type = GESTURE_NONE;
+        if (s_gesture_pending.type != GESTURE_NONE)
+        {
+            gesture_begin(s_gesture_pending.conn_idx, s_gesture_pending.type, s_gesture_pending.is_ios);
+            s_gesture_pending.type = GESTURE_NONE;
+        }
+    }
+    user_clock_release(CLOCK_USER_GESTURE);
+}
+
+/**
+ *****************************************************************************************
+ * @brief Start a gesture now if idle, otherwise queue it in the pending slot so it
+ *        follows the running one without a gap.
+ *****************************************************************************************
+ */
+static void gesture_enqueue(uint8_t conn_idx, gesture_type_t type, bool is_ios)
+{
+    if (s_gesture.type != GESTURE_NONE)
+    {
+        s_gesture_pending.type     = type;
+        s_gesture_pending.is_ios   = is_ios;
+        s_gesture_pending.conn_idx = conn_idx;
+        return;
+    }
+    gesture_begin(conn_idx, type, is_ios);
+    gesture_step_run();
+}
+
+/**
+ *****************************************************************************************
+ * @brief Play the next auto-repeat gesture while the input is held, and speed up.
+ *****************************************************************************************
+ */
+static void gesture_repeat_tick(void)
+{
+    if (s_repeat.type == GESTURE_NONE)
+    {
+        return;
+    }
+    if (!s_repeat.hold_check(s_repeat.hold_arg))
+    {
+        APP_LOG_DEBUG("Gesture %d repeat released", s_repeat.type);
+        s_repeat.type = GESTURE_NONE;
+        return;
+    }
+
+    gesture_enqueue(s_repeat.conn_idx, s_repeat.type, s_repeat.is_ios);
+    app_timer_start(s_repeat_timer_id, s_repeat.interval, NULL);
+
+    s_repeat.interval = s_repeat.interval * GESTURE_REPEAT_ACCEL_PERCENT / 100;
+    if (s_repeat.interval < GESTURE_REPEAT_INTERVAL_MIN_MS)
+    {
+        s_repeat.interval = GESTURE_REPEAT_INTERVAL_MIN_MS;
+    }
+}
+
+/*
+ * GLOBAL FUNCTION DEFINITIONS
+ *****************************************************************************************
+ */
+void user_gesture_init(void)
+{
+    sdk_err_t error_code;
+
+    error_code = app_timer_create(&s_gesture_timer_id, ATIMER_ONE_SHOT, gesture_timer_handler);
+    APP_ERROR_CHECK(error_code);
+
+    error_code = app_timer_create(&s_repeat_timer_id, ATIMER_ONE_SHOT, repeat_timer_handler);
+    APP_ERROR_CHECK(error_code);
+
+    error_code = user_mouse_contact_count_max_set(GESTURE_CONTACTS_MAX);
+    APP_ERROR_CHECK(error_code);
+}
+
+void user_gesture_start(uint8_t conn_idx, gesture_type_t type, bool is_ios)
+{
+    if (type == GESTURE_NONE || type >= GESTURE_MAX)
+    {
+        return;
+    }
+
+    if (s_gesture.type != GESTURE_NONE)
+    {
+        if (s_gesture_desc[type].priority < s_gesture_desc[s_gesture.type].priority)
+        {
+            s_gesture_pending.type     = type;
+            s_gesture_pending.is_ios   = is_ios;
+            s_gesture_pending.conn_idx = conn_idx;
+            return;
+        }
+
+        // Preempt: the new gesture first releases what the running one holds.
+        app_timer_stop(s_gesture_timer_id);
+        s_gesture_step_due = false;
+        APP_LOG_DEBUG("Gesture %d preempted by %d", s_gesture.type, type);
+    }
+
+    gesture_begin(conn_idx, type, is_ios);
+    gesture_step_run();
+}
+
+void user_gesture_repeat_start(uint8_t conn_idx, gesture_type_t type, bool is_ios,
+                               gesture_hold_check_t hold_check, uint8_t hold_arg, uint32_t first_delay_ms)
+{
+    if (type == GESTURE_NONE || type >= GESTURE_MAX || hold_check == NULL)
+    {
+        return;
+    }
+
+    app_timer_stop(s_repeat_timer_id);
+    s_repeat_due        = false;
+    s_repeat.type       = type;
+    s_repeat.is_ios     = is_ios;
+    s_repeat.conn_idx   = conn_idx;
+    s_repeat.hold_check = hold_check;
+    s_repeat.hold_arg   = hold_arg;
+    s_repeat.interval   = GESTURE_REPEAT_INTERVAL_MS;
+    APP_LOG_DEBUG("Gesture %d repeat start", type);
+
+    if (first_delay_ms)
+    {
+        app_timer_start(s_repeat_timer_id, first_delay_ms, NULL);
+    }
+    else
+    {
+        gesture_repeat_tick();
+    }
+}
+
+void user_gesture_repeat_stop(void)
+{
+    app_timer_stop(s_repeat_timer_id);
+    s_repeat_due  = false;
+    s_repeat.type = GESTURE_NONE;
+}
+
+void user_gesture_abort(void)
+{
+    user_gesture_repeat_stop();
+    app_timer_stop(s_gesture_timer_id);
+    s_gesture_step_due     = false;
+    s_gesture.type         = GESTURE_NONE;
+    s_gesture_pending.type = GESTURE_NONE;
+    user_clock_release(CLOCK_USER_GESTURE);
+    user_mouse_release_all(s_gesture.conn_idx);
+}
+
+bool user_gesture_is_busy(void)
+{
+    return (s_gesture.type != GESTURE_NONE) || (s_gesture_pending.type != GESTURE_NONE) ||
+           (s_repeat.type != GESTURE_NONE);
+}
+
+void user_gesture_schedule(void)
+{
+    if (s_gesture_step_due)
+    {
+        s_gesture_step_due = false;
+        gesture_step_run();
+    }
+    if (s_repeat_due)
+    {
+        s_repeat_due = false;
+        gesture_repeat_tick();
+    }
+}
@@ -0,0 +1,148 @@
+/**
+ *****************************************************************************************
+ *
+ * @file user_gesture.h
+ *
+ * @brief Non-blocking, preemptible gesture engine API.
+ *
+ *****************************************************************************************
+ * @attention
+  #####Copyright (c) 2019 GOODIX
+  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of GOODIX nor the names of its contributors may be used
+    to endorse or promote products derived from this software without
+    specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************************
+ */
+#ifndef __USER_GESTURE_H__
+#define __USER_GESTURE_H__
+
+/*
+ * INCLUDE FILES
+ *****************************************************************************************
+ */
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * TYPEDEFS
+ *****************************************************************************************
+ */
+/**@brief Gestures played to the phone. */
+typedef enum
+{
+    GESTURE_NONE,
+    GESTURE_UP,             /**< Next video. */
+    GESTURE_DOWN,           /**< Previous video. */
+    GESTURE_LEFT,
+    GESTURE_RIGHT,
+    GESTURE_DOUBLE,         /**< Double tap, like. */
+    GESTURE_FUNC,           /**< Single tap, pause. */
+    GESTURE_CAMERA,         /**< Camera shutter. */
+    GESTURE_PINCH_IN,       /**< Two fingers apart, zoom in. */
+    GESTURE_PINCH_OUT,      /**< Two fingers together, zoom out. */
+    GESTURE_MAX,
+} gesture_type_t;
+
+/**@brief Check whether the input driving an auto-repeat is still held. */
+typedef bool (*gesture_hold_check_t)(uint8_t arg);
+
+/*
+ * GLOBAL FUNCTION DECLARATION
+ *****************************************************************************************
+ */
+/**
+ *****************************************************************************************
+ * @brief Create the gesture timers and report the most contacts a gesture uses, call after
+ *        user_mouse_service_init().
+ *****************************************************************************************
+ */
+void user_gesture_init(void);
+
+/**
+ *****************************************************************************************
+ * @brief Start a gesture.
+ *
+ * @details A gesture of the same or higher priority than the running one preempts it:
+ *          everything held on the host is released and the new gesture starts at the
+ *          next connection event. A lower priority gesture waits in a single pending
+ *          slot, a newer one replaces it.
+ *
+ * @param[in] conn_idx: Connection index.
+ * @param[in] type:     Gesture to play.
+ * @param[in] is_ios:   true to play the iOS (mouse) variant, false for the Android (finger) one.
+ *****************************************************************************************
+ */
+void user_gesture_start(uint8_t conn_idx, gesture_type_t type, bool is_ios);
+
+/**
+ *****************************************************************************************
+ * @brief Repeat a gesture while an input is held.
+ *
+ * @details The first gesture starts after first_delay_ms, 0 plays it right away. The next ones follow every repeat
+ *          interval, starting at GESTURE_REPEAT_INTERVAL_MS and shrinking by
+ *          GESTURE_REPEAT_ACCEL_PERCENT per repeat down to GESTURE_REPEAT_INTERVAL_MIN_MS.
+ *          A repeat due while the previous gesture still plays is queued behind it and
+ *          starts on the same step the previous one completes. The repeat ends at the
+ *          first tick where hold_check returns false.
+ *
+ * @param[in] conn_idx:   Connection index.
+ * @param[in] type:       Gesture to repeat.
+ * @param[in] is_ios:     true to play the iOS (mouse) variant, false for the Android (finger) one.
+ * @param[in] hold_check: Called before every repeat.
+ * @param[in] hold_arg:   Argument of hold_check.
+ * @param[in] first_delay_ms: Delay of the first gesture, in ms.
+ *****************************************************************************************
+ */
+void user_gesture_repeat_start(uint8_t conn_idx, gesture_type_t type, bool is_ios,
+                               gesture_hold_check_t hold_check, uint8_t hold_arg, uint32_t first_delay_ms);
+
+/**
+ *****************************************************************************************
+ * @brief Stop auto-repeat, the gesture already playing completes.
+ *****************************************************************************************
+ */
+void user_gesture_repeat_stop(void);
+
+/**
+ *****************************************************************************************
+ * @brief Drop the running and pending gestures, used when the link is gone.
+ *****************************************************************************************
+ */
+void user_gesture_abort(void);
+
+/**
+ *****************************************************************************************
+ * @brief Check whether a gesture is running or pending.
+ *****************************************************************************************
+ */
+bool user_gesture_is_busy(void);
+
+/**
+ *****************************************************************************************
+ * @brief Run the due gesture step, called from the main loop.
+ *****************************************************************************************
+ */
+void user_gesture_schedule(void);
+
+#endif
@@ -0,0 +1,264 @@
+/**
+ *****************************************************************************************
+ *
+ * @file user_latency.c
+ *
+ * @brief Key-to-air latency instrumentation implementation.
+ *
+ *****************************************************************************************
+ * @attention
+  #####Copyright (c) 2019 GOODIX
+  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of GOODIX nor the names of its contributors may be used
+    to endorse or promote products derived from this software without
+    specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************************
+ */
+/*
+ * INCLUDE FILES
+ *****************************************************************************************
+ */
+#include "user_latency.h"
+#include "user_perf.h"
+#include "app_log.h"
+#include <string.h>
+
+/*
+ * DEFINES
+ *****************************************************************************************
+ */
+#define LATENCY_SUB_BUCKET_BITS     2           /**< log2 of buckets per power of 2. */
+
+/*
+ * STRUCT DEFINE
+ *****************************************************************************************
+ */
+/**@brief Record stages of the key event in flight. */
+typedef enum
+{
+    LATENCY_STATE_IDLE,
+    LATENCY_STATE_WAIT_REPORT,
+    LATENCY_STATE_WAIT_AIR,
+} latency_state_t;
+
+/**@brief Histogram of one span, in us. */
+typedef struct
+{
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint16_t bucket[USER_LATENCY_BUCKET_NB];
+} latency_hist_t;
+
+/*
+ * LOCAL VARIABLE DEFINITIONS
+ *****************************************************************************************
+ */
+static const char *const s_span_name[LATENCY_SPAN_NB] = {"dispatch", "gesture", "air", "total"};
+
+static latency_state_t s_state = LATENCY_STATE_IDLE;
+static uint32_t        s_edge_us;
+static uint32_t        s_dispatch_us;
+static uint32_t        s_report_us;
+static latency_hist_t  s_hist[LATENCY_SPAN_NB];
+
+/*
+ * LOCAL FUNCTION DEFINITIONS
+ *****************************************************************************************
+ */
+/**
+ *****************************************************************************************
+ * @brief Bucket of a value: exact below 4 us, then 4 buckets per power of 2.
+ *****************************************************************************************
+ */
+static uint8_t latency_bucket_idx(uint32_t us)
+{
+    uint8_t  msb = 31 - __builtin_clz(us | 1);
+    uint32_t idx;
+
+    if (msb < LATENCY_SUB_BUCKET_BITS)
+    {
+        return us;
+    }
+    idx = ((msb - LATENCY_SUB_BUCKET_BITS + 1) << LATENCY_SUB_BUCKET_BITS) +
+          ((us >> (msb - LATENCY_SUB_BUCKET_BITS)) & ((1 << LATENCY_SUB_BUCKET_BITS) - 1));
+
+    return (idx < USER_LATENCY_BUCKET_NB) ? idx : (USER_LATENCY_BUCKET_NB - 1);
+}
+
+/**
+ *****************************************************************************************
+ * @brief Largest value falling into a bucket.
+ *****************************************************************************************
+ */
+static uint32_t latency_bucket_upper(uint8_t idx)
+{
+    uint8_t group = idx >> LATENCY_SUB_BUCKET_BITS;
+    uint8_t sub   = idx & ((1 << LATENCY_SUB_BUCKET_BITS) - 1);
+
+    if (group == 0)
+    {
+        return idx;
+    }
+    return (((1 << LATENCY_SUB_BUCKET_BITS) + sub + 1) << (group - 1)) - 1;
+}
+
+static void latency_hist_add(latency_hist_t *p_hist, uint32_t us)
+{
+    uint8_t idx = latency_bucket_idx(us);
+
+    p_hist->count++;
+    p_hist->sum += us;
+    if (us < p_hist->min || p_hist->count == 1)
+    {
+        p_hist->min = us;
+    }
+    if (us > p_hist->max)
+    {
+        p_hist->max = us;
+    }
+    if (p_hist->bucket[idx] < UINT16_MAX)
+    {
+        p_hist->bucket[idx]++;
+    }
+}
+
+/*
+ * GLOBAL FUNCTION DEFINITIONS
+ *****************************************************************************************
+ */
+void user_latency_key_event(uint32_t edge_us)
+{
+    if (s_state != LATENCY_STATE_IDLE)
+    {
+        return;
+    }
+    s_edge_us     = edge_us;
+    s_dispatch_us = user_perf_now_us();
+    s_state       = LATENCY_STATE_WAIT_REPORT;
+}
+
+void user_latency_report_queued(void)
+{
+    if (s_state != LATENCY_STATE_WAIT_REPORT)
+    {
+        return;
+    }
+    s_report_us = user_perf_now_us();
+    s_state     = LATENCY_STATE_WAIT_AIR;
+}
+
+void user_latency_ntf_sent(void)
+{
+    uint32_t now = user_perf_now_us();
+    uint32_t us[LATENCY_SPAN_NB];
+
+    if (s_state != LATENCY_STATE_WAIT_AIR)
+    {
+        return;
+    }
+    s_state = LATENCY_STATE_IDLE;
+
+    us[LATENCY_SPAN_DISPATCH] = s_dispatch_us - s_edge_us;
+    us[LATENCY_SPAN_GESTURE]  = s_report_us - s_dispatch_us;
+    us[LATENCY_SPAN_AIR]      = now - s_report_us;
+    us[LATENCY_SPAN_TOTAL]    = now - s_edge_us;
+    for (uint8_t span = 0; span < LATENCY_SPAN_NB; span++)
+    {
+        latency_hist_add(&s_hist[span], us[span]);
+    }
+    APP_LOG_DEBUG("Key latency us: dispatch %d, gesture %d, air %d, total %d",
+                  us[LATENCY_SPAN_DISPATCH], us[LATENCY_SPAN_GESTURE], us[LATENCY_SPAN_AIR], us[LATENCY_SPAN_TOTAL]);
+
+#if USER_LATENCY_DUMP_EVERY
+    if ((s_hist[LATENCY_SPAN_TOTAL].count % USER_LATENCY_DUMP_EVERY) == 0)
+    {
+        user_latency_dump();
+    }
+#endif
+}
+
+void user_latency_report_refused(void)
+{
+    if (s_state == LATENCY_STATE_WAIT_REPORT)
+    {
+        s_state = LATENCY_STATE_IDLE;
+    }
+}
+
+void user_latency_abort(void)
+{
+    s_state = LATENCY_STATE_IDLE;
+}
+
+void user_latency_summary_get(latency_span_t span, latency_summary_t *p_summary)
+{
+    const latency_hist_t *p_hist = &s_hist[span];
+    uint32_t              target;
+    uint32_t              cumulated = 0;
+
+    memset(p_summary, 0, sizeof(latency_summary_t));
+    if (span >= LATENCY_SPAN_NB || p_hist->count == 0)
+    {
+        return;
+    }
+
+    p_summary->count = p_hist->count;
+    p_summary->min   = p_hist->min;
+    p_summary->max   = p_hist->max;
+    p_summary->avg   = (uint32_t)(p_hist->sum / p_hist->count);
+
+    target = (p_hist->count * 99 + 99) / 100;
+    for (uint8_t idx = 0; idx < USER_LATENCY_BUCKET_NB; idx++)
+    {
+        cumulated += p_hist->bucket[idx];
+        if (cumulated >= target)
+        {
+            p_summary->p99 = latency_bucket_upper(idx);
+            break;
+        }
+    }
+    if (p_summary->p99 > p_summary->max)
+    {
+        p_summary->p99 = p_summary->max;
+    }
+}
+
+void user_latency_dump(void)
+{
+    latency_summary_t summary;
+
+    for (uint8_t span = 0; span < LATENCY_SPAN_NB; span++)
+    {
+        user_latency_summary_get((latency_span_t)span, &summary);
+        APP_LOG_INFO("Latency %-8s n %d, min %d, avg %d, max %d, p99 %d us",
+                     s_span_name[span], summary.count, summary.min, summary.avg, summary.max, summary.p99);
+    }
+}
+
+void user_latency_reset(void)
+{
+    memset(s_hist, 0, sizeof(s_hist));
+    s_state = LATENCY_STATE_IDLE;
+}
@@ -0,0 +1,141 @@
+/**
+ *****************************************************************************************
+ *
+ * @file user_latency.h
+ *
+ * @brief Key-to-air latency instrumentation API.
+ *
+ *****************************************************************************************
+ * @attention
+  #####Copyright (c) 2019 GOODIX
+  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of GOODIX nor the names of its contributors may be used
+    to endorse or promote products derived from this software without
+    specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************************
+ */
+#ifndef __USER_LATENCY_H__
+#define __USER_LATENCY_H__
+
+/*
+ * INCLUDE FILES
+ *****************************************************************************************
+ */
+#include "gr_includes.h"
+
+/*
+ * DEFINES
+ *****************************************************************************************
+ */
+#define USER_LATENCY_BUCKET_NB      96          /**< 4 buckets per power of 2 of us, covers up to 16 s. */
+#define USER_LATENCY_DUMP_EVERY     32          /**< Dump the histograms to the log every this many records, 0 to disable. */
+
+/*
+ * TYPEDEFS
+ *****************************************************************************************
+ */
+/**@brief Measured spans of one key event. */
+typedef enum
+{
+    LATENCY_SPAN_DISPATCH,      /**< Key edge (or app_key event) to the main loop handling it. */
+    LATENCY_SPAN_GESTURE,       /**< Main loop handling to the first report queued to the stack. */
+    LATENCY_SPAN_AIR,           /**< First report queued to its notification sent on air (BLE_GATTS_EVT_NTF_IND). */
+    LATENCY_SPAN_TOTAL,         /**< Key edge to notification sent on air. */
+    LATENCY_SPAN_NB,
+} latency_span_t;
+
+/**@brief Summary of one span, in us. */
+typedef struct
+{
+    uint32_t count;
+    uint32_t min;
+    uint32_t avg;
+    uint32_t max;
+    uint32_t p99;               /**< Upper bound of the bucket holding the 99th percentile. */
+} latency_summary_t;
+
+/*
+ * GLOBAL FUNCTION DECLARATION
+ *****************************************************************************************
+ */
+/**
+ *****************************************************************************************
+ * @brief A key event is handled by the main loop, starts a record. A record still
+ *        waiting for its report is kept, so a burst counts from its first key.
+ *
+ * @param[in] edge_us: user_perf_now_us() when the key event happened.
+ *****************************************************************************************
+ */
+void user_latency_key_event(uint32_t edge_us);
+
+/**
+ *****************************************************************************************
+ * @brief An input report was queued to the stack.
+ *****************************************************************************************
+ */
+void user_latency_report_queued(void);
+
+/**
+ *****************************************************************************************
+ * @brief A notification was sent on air, completes the record waiting for it.
+ *****************************************************************************************
+ */
+void user_latency_ntf_sent(void);
+
+/**
+ *****************************************************************************************
+ * @brief An input report was refused by the stack. Only a record still waiting for its
+ *        first report is dropped, one whose first report is in flight is kept.
+ *****************************************************************************************
+ */
+void user_latency_report_refused(void);
+
+/**
+ *****************************************************************************************
+ * @brief Drop the record in flight, notifications were disabled or the link went down.
+ *****************************************************************************************
+ */
+void user_latency_abort(void);
+
+/**
+ *****************************************************************************************
+ * @brief Get the summary of one span.
+ *****************************************************************************************
+ */
+void user_latency_summary_get(latency_span_t span, latency_summary_t *p_summary);
+
+/**
+ *****************************************************************************************
+ * @brief Print min/avg/max/p99 of every span to the log.
+ *****************************************************************************************
+ */
+void user_latency_dump(void);
+
+/**
+ *****************************************************************************************
+ * @brief Clear all histograms.
+ *****************************************************************************************
+ */
+void user_latency_reset(void);
+
+#endif
@@ -0,0 +1,383 @@
+/**
+ *****************************************************************************************
+ *
+ * @file user_link.c
+ *
+ * @brief Link tuning: PHY negotiation and fallback, RSSI driven TX power.
+ *
+ *****************************************************************************************
+ * @attention
+  #####Copyright (c) 2019 GOODIX
+  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of GOODIX nor the names of its contributors may be used
+    to endorse or promote products derived from this software without
+    specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ *****************************************************************************************
+ */
+#include "user_link.h"
+#include "user_bond.h"
+#include "user_stats.h"
+#include "app_log.h"
+#include "app_error.h"
+#include "app_timer.h"
+#include <string.h>
+
+/*
+ * DEFINES
+ *****************************************************************************************
+ */
+#define LINK_PHY_1M         1       /**< PHY value in BLE_GAPC_EVT_PHY_UPDATED. */
+#define LINK_PHY_2M         2
+#define LINK_PHY(tx, rx)    (((rx) << 4) | (tx))
+
+/*
+ * STRUCT DEFINE
+ *****************************************************************************************
+ */
+/**@brief Link state. */
+typedef struct
+{
+    uint8_t phy;            /**< LINK_PHY(tx, rx), 0 when the link is down. */
+    uint8_t fails;          /**< Reports refused since a notification was last sent on air. */
+    bool    fallback;       /**< Dropped to 1M on this link. */
+    bool    failed_2m;      /**< Refused reports piled up on 2M during this link. */
+    bool    refused;        /**< A report was refused since the last RSSI sample. */
+    bool    rssi_valid;
+    int16_t rssi_avg8;      /**< Average RSSI in 1/8 dBm. */
+    int8_t  tx_power;       /**< Connection TX power in dBm. */
+    uint8_t healthy;        /**< Healthy RSSI samples since the TX power last changed. */
+} link_env_t;
+
+/*
+ * LOCAL VARIABLE DEFINITIONS
+ *****************************************************************************************
+ */
+static link_env_t     s_link_env[CFG_MAX_CONNECTIONS];
+static app_timer_id_t s_link_rssi_timer_id;
+static bool           s_link_rssi_timer_on;
+
+/*
+ * LOCAL FUNCTION DEFINITIONS
+ *****************************************************************************************
+ */
+static bool link_on_2m(const link_env_t *p_env)
+{
+    return (p_env->phy & 0x0F) == LINK_PHY_2M || (p_env->phy >> 4) == LINK_PHY_2M;
+}
+
+/**
+ *****************************************************************************************
+ * @brief Drop a 2M link to 1M, the longer symbols hold up better at the edge of range.
+ *****************************************************************************************
+ */
+static void link_phy_fallback(uint8_t conn_idx)
+{
+    link_env_t       *p_env  = &s_link_env[conn_idx];
+    user_bond_peer_t *p_bond = user_bond_peer_get(conn_idx);
+    sdk_err_t         error_code;
+
+    p_env->fallback  = true;
+    p_env->failed_2m = true;
+    error_code = ble_gap_phy_update(conn_idx, BLE_GAP_PHY_LE_1MBPS, BLE_GAP_PHY_LE_1MBPS, BLE_GAP_PHY_OPT_NO_CODING);
+    APP_LOG_WARNING("Conn %d: %d reports refused on 2M, falling back to 1M (0x%x).", conn_idx, p_env->fails, error_code);
+
+    if (p_bond && !(p_bond->flags & USER_BOND_FLAG_PHY_1M))
+    {
+        p_bond->flags |= USER_BOND_FLAG_PHY_1M;
+        user_bond_peer_save(conn_idx);
+    }
+}
+
+#if USER_LINK_TXPWR_ENABLE
+/**
+ *****************************************************************************************
+ * @brief Change the TX power of a link and log why, for tuning the thresholds.
+ *****************************************************************************************
+ */
+static void link_tx_power_set(uint8_t conn_idx, int8_t dbm, const char *p_why)
+{
+    link_env_t *p_env = &s_link_env[conn_idx];
+    sdk_err_t   error_code;
+
+    p_env->healthy = 0;
+    if (dbm == p_env->tx_power)
+    {
+        return;
+    }
+    error_code = ble_gap_tx_power_set(BLE_GAP_ACTIVITY_ROLE_CON, conn_idx, dbm);
+    APP_LOG_INFO("Conn %d: TX power %d -> %d dBm, %s, rssi avg %d, refused %d (0x%x).",
+                 conn_idx, p_env->tx_power, dbm, p_why, p_env->rssi_avg8 / 8, p_env->fails, error_code);
+    if (SDK_SUCCESS == error_code)
+    {
+        p_env->tx_power = dbm;
+        user_stats_tx_power(dbm);
+    }
+}
+
+/**
+ *****************************************************************************************
+ * @brief Track the RSSI and step the TX power towards what the path loss calls for.
+ *        The RSSI is what the peer sends with, the loss is about the same both ways.
+ *****************************************************************************************
+ */
+static void link_rssi_process(uint8_t conn_idx, int8_t rssi)
+{
+    link_env_t *p_env = &s_link_env[conn_idx];
+    int16_t     target;
+
+    if (!p_env->rssi_valid)
+    {
+        p_env->rssi_avg8  = rssi * 8;
+        p_env->rssi_valid = true;
+    }
+    else
+    {
+        p_env->rssi_avg8 += (rssi * 8 - p_env->rssi_avg8) / 4;
+    }
+
+    target = USER_LINK_TXPWR_START_DBM - (p_env->rssi_avg8 / 8 - USER_LINK_RSSI_TARGET_DBM);
+    target = (target > USER_LINK_TXPWR_MAX_DBM) ? USER_LINK_TXPWR_MAX_DBM : target;
+    target = (target < USER_LINK_TXPWR_MIN_DBM) ? USER_LINK_TXPWR_MIN_DBM : target;
+
+    if (target > p_env->tx_power)
+    {
+        // The peer moved away, catch up at once.
+        link_tx_power_set(conn_idx, target, "rssi dropped");
+    }
+    else if (p_env->refused)
+    {
+        p_env->healthy = 0;
+    }
+    else if (++p_env->healthy >= USER_LINK_TXPWR_HOLD && p_env->tx_power - USER_LINK_TXPWR_STEP_DB >= target)
+    {
+        link_tx_power_set(conn_idx, p_env->tx_power - USER_LINK_TXPWR_STEP_DB, "link healthy");
+    }
+    p_env->refused = false;
+}
+
+static void link_rssi_timer_handler(void *p_arg)
+{
+    for (uint8_t conn_idx = 0; conn_idx < CFG_MAX_CONNECTIONS; conn_idx++)
+    {
+        if (s_link_env[conn_idx].phy)
+        {
+            ble_gap_conn_info_get(conn_idx, BLE_GAP_GET_CON_RSSI);
+        }
+    }
+}
+#endif
+
+/*
+ * GLOBAL FUNCTION DEFINITIONS
+ *****************************************************************************************
+ */
+void user_link_init(void)
+{
+    uint8_t   phys = BLE_GAP_PHY_LE_1MBPS | ((USER_LINK_PHY_PREF == BLE_GAP_PHY_LE_2MBPS) ? BLE_GAP_PHY_LE_2MBPS : 0);
+    sdk_err_t error_code;
+
+    memset(s_link_env, 0, sizeof(s_link_env));
+    error_code = ble_gap_pref_phy_set(phys, phys);
+    APP_ERROR_CHECK(error_code);
+#if USER_LINK_TXPWR_ENABLE
+    error_code = app_timer_create(&s_link_rssi_timer_id, ATIMER_REPEAT, link_rssi_timer_handler);
+    APP_ERROR_CHECK(error_code);
+#endif
+}
+
+void user_link_connected(uint8_t conn_idx)
+{
+    link_env_t       *p_env;
+    user_bond_peer_t *p_bond;
+
+    if (conn_idx >= CFG_MAX_CONNECTIONS)
+    {
+        return;
+    }
+    p_env  = &s_link_env[conn_idx];
+    p_bond = user_bond_peer_get(conn_idx);
+    memset(p_env, 0, sizeof(*p_env));
+    p_env->phy = LINK_PHY(LINK_PHY_1M, LINK_PHY_1M);
+    user_stats_phy(p_env->phy);
+
+#if USER_LINK_TXPWR_ENABLE
+    // Start at the default power, the RSSI samples and refused reports move it from there.
+    if (SDK_SUCCESS == ble_gap_tx_power_set(BLE_GAP_ACTIVITY_ROLE_CON, conn_idx, USER_LINK_TXPWR_START_DBM))
+    {
+        p_env->tx_power = USER_LINK_TXPWR_START_DBM;
+        user_stats_tx_power(p_env->tx_power);
+    }
+    if (!s_link_rssi_timer_on && SDK_SUCCESS == app_timer_start(s_link_rssi_timer_id, USER_LINK_RSSI_PERIOD_MS, NULL))
+    {
+        s_link_rssi_timer_on = true;
+    }
+#endif
+
+    if (USER_LINK_PHY_PREF != BLE_GAP_PHY_LE_2MBPS)
+    {
+        return;
+    }
+    if (p_bond && (p_bond->flags & USER_BOND_FLAG_PHY_1M))
+    {
+        p_env->fallback = true;
+        APP_LOG_INFO("Conn %d: 2M failed with this peer last time, staying on 1M.", conn_idx);
+        return;
+    }
+    ble_gap_phy_update(conn_idx, BLE_GAP_PHY_LE_2MBPS, BLE_GAP_PHY_LE_2MBPS, BLE_GAP_PHY_OPT_NO_CODING);
+}
+
+void user_link_phy_updated(uint8_t conn_idx, uint8_t status, const ble_gap_evt_phy_update_t *p_phy)
+{
+    link_env_t *p_env;
+
+    if (conn_idx >= CFG_MAX_CONNECTIONS)
+    {
+        return;
+    }
+    p_env = &s_link_env[conn_idx];
+
+    if (BLE_SUCCESS != status)
+    {
+        APP_LOG_INFO("Conn %d: PHY update failed (0x%x), staying on tx %d rx %d.",
+                     conn_idx, status, p_env->phy & 0x0F, p_env->phy >> 4);
+        return;
+    }
+    p_env->phy   = LINK_PHY(p_phy->tx_phy, p_phy->rx_phy);
+    p_env->fails = 0;
+    user_stats_phy(p_env->phy);
+    APP_LOG_INFO("Conn %d: PHY tx %d rx %d.", conn_idx, p_phy->tx_phy, p_phy->rx_phy);
+
+    // The peer may move the link back to 2M by itself, hold it to 1M.
+    if (p_env->fallback && link_on_2m(p_env))
+    {
+        ble_gap_phy_update(conn_idx, BLE_GAP_PHY_LE_1MBPS, BLE_GAP_PHY_LE_1MBPS, BLE_GAP_PHY_OPT_NO_CODING);
+    }
+}
+
+void user_link_report_result(uint8_t conn_idx, sdk_err_t err)
+{
+    link_env_t *p_env;
+
+    if (conn_idx >= CFG_MAX_CONNECTIONS)
+    {
+        return;
+    }
+    p_env = &s_link_env[conn_idx];
+
+    // Only a full stack queue says the air is not draining, other errors are local.
+    if (SDK_ERR_NO_RESOURCES != err)
+    {
+        return;
+    }
+    if (p_env->fails < UINT8_MAX)
+    {
+        p_env->fails++;
+    }
+    p_env->refused = true;
+#if USER_LINK_TXPWR_ENABLE
+    if ((p_env->fails % USER_LINK_TXPWR_RAISE_FAILS) == 0 && p_env->tx_power < USER_LINK_TXPWR_MAX_DBM)
+    {
+        link_tx_power_set(conn_idx, (p_env->tx_power + USER_LINK_TXPWR_STEP_DB > USER_LINK_TXPWR_MAX_DBM) ?
+                          USER_LINK_TXPWR_MAX_DBM : p_env->tx_power + USER_LINK_TXPWR_STEP_DB, "reports refused");
+    }
+#endif
+    if (!p_env->fallback && link_on_2m(p_env) && p_env->fails >= USER_LINK_PHY_FALLBACK_FAILS)
+    {
+        link_phy_fallback(conn_idx);
+    }
+}
+
+void user_link_ntf_sent(uint8_t conn_idx)
+{
+    if (conn_idx < CFG_MAX_CONNECTIONS)
+    {
+        s_link_env[conn_idx].fails = 0;
+    }
+}
+
+void user_link_conn_info(uint8_t conn_idx, uint8_t status, const ble_gap_evt_conn_info_t *p_info)
+{
+#if USER_LINK_TXPWR_ENABLE
+    if (conn_idx < CFG_MAX_CONNECTIONS && s_link_env[conn_idx].phy &&
+        BLE_SUCCESS == status && BLE_GAP_GET_CON_RSSI == p_info->opcode)
+    {
+        link_rssi_process(conn_idx, p_info->info.rssi);
+    }
+#endif
+}
+
+void user_link_disconnected(uint8_t conn_idx, uint8_t reason)
+{
+    link_env_t       *p_env;
+    user_bond_peer_t *p_bond;
+
+    if (conn_idx >= CFG_MAX_CONNECTIONS)
+    {
+        return;
+    }
+    p_env  = &s_link_env[conn_idx];
+    p_bond = user_bond_peer_get(conn_idx);
+
+    if (p_bond)
+    {
+        if (BLE_LL_ERR_CON_TIMEOUT == reason && link_on_2m(p_env))
+        {
+            // Link lost on 2M, start the next one on 1M.
+            p_env->failed_2m = true;
+            p_bond->flags   |= USER_BOND_FLAG_PHY_1M;
+            user_bond_peer_save(conn_idx);
+        }
+        else if (BLE_LL_ERR_CON_TIMEOUT != reason && !p_env->failed_2m && (p_bond->flags & USER_BOND_FLAG_PHY_1M))
+        {
+            // A clean link on 1M, give 2M another try next time.
+            p_bond->flags &= ~USER_BOND_FLAG_PHY_1M;
+            user_bond_peer_save(conn_idx);
+        }
+    }
+    memset(p_env, 0, sizeof(*p_env));
+    user_stats_phy(0);
+    user_stats_tx_power(0);
+
+    for (conn_idx = 0; conn_idx < CFG_MAX_CONNECTIONS; conn_idx++)
+    {
+        if (s_link_env[conn_idx].phy)
+        {
+            return;
+        }
+    }
+    if (s_link_rssi_timer_on)
+    {
+        app_timer_stop(s_link_rssi_timer_id);
+        s_link_rssi_timer_on = false;
+    }
+}
+
+uint8_t user_link_phy_get(uint8_t conn_idx)
+{
+    return (conn_idx < CFG_MAX_CONNECTIONS) ? s_link_env[conn_idx].phy : 0;
+}
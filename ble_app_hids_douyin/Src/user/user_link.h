@@ -0,0 +1,135 @@
+/**
+ *****************************************************************************************
+ *
+ * @file user_link.h
+ *
+ * @brief Link tuning: PHY negotiation and fallback, RSSI driven TX power.
+ *
+ *****************************************************************************************
+ * @attention
+  #####Copyright (c) 2019 GOODIX
+  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of GOODIX nor the names of its contributors may be used
+    to endorse or promote products derived from this software without
+    specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************************
+ */
+#ifndef __USER_LINK_H__
+#define __USER_LINK_H__
+
+/*
+ * INCLUDE FILES
+ *****************************************************************************************
+ */
+#include "gr_includes.h"
+#include "custom_config.h"
+
+/*
+ * DEFINES
+ *****************************************************************************************
+ */
+#define USER_LINK_PHY_PREF              BLE_GAP_PHY_LE_2MBPS    /**< PHY asked for on connect, BLE_GAP_PHY_LE_1MBPS to stay on 1M. */
+#define USER_LINK_PHY_FALLBACK_FAILS    8                       /**< Reports refused in a row with nothing sent on air before a 2M link drops to 1M. */
+
+#define USER_LINK_TXPWR_ENABLE          1                       /**< Lower the connection TX power while the peer is close. */
+#if (RF_TX_PA_SELECT == 3)
+#define USER_LINK_TXPWR_MAX_DBM         15                      /**< HPA. */
+#define USER_LINK_TXPWR_MIN_DBM         (-10)
+#elif (RF_TX_PA_SELECT == 2)
+#define USER_LINK_TXPWR_MAX_DBM         2                       /**< UPA. */
+#define USER_LINK_TXPWR_MIN_DBM         (-15)
+#else
+#define USER_LINK_TXPWR_MAX_DBM         5                       /**< SPA. */
+#define USER_LINK_TXPWR_MIN_DBM         (-20)
+#endif
+#define USER_LINK_TXPWR_START_DBM       0                       /**< Power a link starts at, the SDK default used before power control. */
+#define USER_LINK_TXPWR_STEP_DB         3                       /**< Power is lowered, or raised on refused reports, by this much at a time. */
+#define USER_LINK_TXPWR_HOLD            5                       /**< Healthy RSSI samples in a row before each step down. */
+#define USER_LINK_TXPWR_RAISE_FAILS     2                       /**< Reports refused in a row before each step up. */
+#define USER_LINK_RSSI_PERIOD_MS        1000                    /**< RSSI sampling period while connected. */
+#define USER_LINK_RSSI_TARGET_DBM       (-60)                   /**< Average RSSI the start power is kept at, every dB above takes 1 dB off, every dB below adds 1 dB. */
+
+/*
+ * GLOBAL FUNCTION DECLARATION
+ *****************************************************************************************
+ */
+/**
+ *****************************************************************************************
+ * @brief Set the PHYs the device accepts, call after the stack is up.
+ *****************************************************************************************
+ */
+void user_link_init(void);
+
+/**
+ *****************************************************************************************
+ * @brief Ask for USER_LINK_PHY_PREF, call after user_bond_connected(). A bonded peer
+ *        whose last 2M link failed stays on 1M.
+ *****************************************************************************************
+ */
+void user_link_connected(uint8_t conn_idx);
+
+/**
+ *****************************************************************************************
+ * @brief The link PHY changed, on BLE_GAPC_EVT_PHY_UPDATED.
+ *****************************************************************************************
+ */
+void user_link_phy_updated(uint8_t conn_idx, uint8_t status, const ble_gap_evt_phy_update_t *p_phy);
+
+/**
+ *****************************************************************************************
+ * @brief Outcome of one input report sent to the stack.
+ *****************************************************************************************
+ */
+void user_link_report_result(uint8_t conn_idx, sdk_err_t err);
+
+/**
+ *****************************************************************************************
+ * @brief A notification was sent on air.
+ *****************************************************************************************
+ */
+void user_link_ntf_sent(uint8_t conn_idx);
+
+/**
+ *****************************************************************************************
+ * @brief Connection information read, on BLE_GAPC_EVT_CONN_INFO_GOT.
+ *****************************************************************************************
+ */
+void user_link_conn_info(uint8_t conn_idx, uint8_t status, const ble_gap_evt_conn_info_t *p_info);
+
+/**
+ *****************************************************************************************
+ * @brief Record how a link ended, call before user_bond_disconnected().
+ *****************************************************************************************
+ */
+void user_link_disconnected(uint8_t conn_idx, uint8_t reason);
+
+/**
+ *****************************************************************************************
+ * @brief PHY in use, tx in bits 0-3 and rx in bits 4-7, 1 for 1M and 2 for 2M.
+ *
+ * @return 0 when the link is down.
+ *****************************************************************************************
+ */
+uint8_t user_link_phy_get(uint8_t conn_idx);
+
+#endif
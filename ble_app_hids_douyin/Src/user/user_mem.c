@@ -0,0 +1,151 @@
+/**
+ *****************************************************************************************
+ *
+ * @file user_mem.c
+ *
+ * @brief Stack and BLE heap high-water mark implementation.
+ *
+ *****************************************************************************************
+ * @attention
+  #####Copyright (c) 2019 GOODIX
+  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of GOODIX nor the names of its contributors may be used
+    to endorse or promote products derived from this software without
+    specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************************
+ */
+/*
+ * INCLUDE FILES
+ *****************************************************************************************
+ */
+#include "user_mem.h"
+#include "app_log.h"
+#include "custom_config.h"
+
+/*
+ * STRUCT DEFINE
+ *****************************************************************************************
+ */
+/**@brief Bounds of one painted region. */
+typedef struct
+{
+    uint32_t *p_base;
+    uint32_t  size;
+} mem_region_t;
+
+/*
+ * GLOBAL VARIABLE DEFINITIONS
+ *****************************************************************************************
+ */
+user_mem_usage_t g_user_mem_usage[USER_MEM_REGION_NB];
+
+/*
+ * LOCAL VARIABLE DEFINITIONS
+ *****************************************************************************************
+ */
+static const char *const s_mem_region_name[USER_MEM_REGION_NB] = {"stack", "env heap", "msg heap"};
+static mem_region_t      s_mem_region[USER_MEM_REGION_NB];
+
+/*
+ * LOCAL FUNCTION DEFINITIONS
+ *****************************************************************************************
+ */
+static void mem_fill(uint32_t *p_start, uint32_t *p_end)
+{
+    while (p_start < p_end)
+    {
+        *p_start++ = USER_MEM_PAINT;
+    }
+}
+
+/*
+ * GLOBAL FUNCTION DEFINITIONS
+ *****************************************************************************************
+ */
+void user_mem_paint(const stack_heaps_table_t *p_heaps)
+{
+    // Entry 0 of the vector table is the initial stack pointer, the same on every toolchain.
+    uint32_t  stack_top = *(const uint32_t *)SCB->VTOR;
+    uint32_t *p_sp      = (uint32_t *)((__get_MSP() - USER_MEM_STACK_MARGIN) & ~0x3UL);
+
+    s_mem_region[USER_MEM_STACK].p_base    = (uint32_t *)(stack_top - SYSTEM_STACK_SIZE);
+    s_mem_region[USER_MEM_STACK].size      = SYSTEM_STACK_SIZE;
+    s_mem_region[USER_MEM_ENV_HEAP].p_base = p_heaps->env_heap_base;
+    s_mem_region[USER_MEM_ENV_HEAP].size   = p_heaps->env_heap_size;
+    s_mem_region[USER_MEM_MSG_HEAP].p_base = p_heaps->msg_heap_base;
+    s_mem_region[USER_MEM_MSG_HEAP].size   = p_heaps->msg_heap_size;
+
+    mem_fill(s_mem_region[USER_MEM_STACK].p_base, p_sp);
+    for (uint8_t region = USER_MEM_ENV_HEAP; region < USER_MEM_REGION_NB; region++)
+    {
+        mem_fill(s_mem_region[region].p_base, s_mem_region[region].p_base + s_mem_region[region].size / sizeof(uint32_t));
+    }
+}
+
+void user_mem_usage_get(user_mem_region_t region, user_mem_usage_t *p_usage)
+{
+    const uint32_t *p_word = s_mem_region[region].p_base;
+    uint32_t        words  = s_mem_region[region].size / sizeof(uint32_t);
+    uint32_t        unused = 0;
+
+    if (region == USER_MEM_STACK)
+    {
+        // The stack grows down from the top, the first overwritten word is the deepest use.
+        while (unused < words && p_word[unused] == USER_MEM_PAINT)
+        {
+            unused++;
+        }
+    }
+    else
+    {
+        // Allocations land anywhere in a heap, count every word still painted.
+        for (uint32_t i = 0; i < words; i++)
+        {
+            unused += (p_word[i] == USER_MEM_PAINT);
+        }
+    }
+
+    p_usage->size = s_mem_region[region].size;
+    p_usage->peak = (words - unused) * sizeof(uint32_t);
+}
+
+void user_mem_dump(void)
+{
+    for (uint8_t region = 0; region < USER_MEM_REGION_NB; region++)
+    {
+        user_mem_usage_get((user_mem_region_t)region, &g_user_mem_usage[region]);
+        if (g_user_mem_usage[region].size == 0)
+        {
+            continue;
+        }
+        if (g_user_mem_usage[region].peak == g_user_mem_usage[region].size)
+        {
+            // Nothing left painted: really full, or cleared after painting.
+            APP_LOG_WARNING("Mem %s: %d bytes all used or not painted", s_mem_region_name[region],
+                            g_user_mem_usage[region].size);
+            continue;
+        }
+        APP_LOG_INFO("Mem %s: peak %d of %d bytes", s_mem_region_name[region],
+                     g_user_mem_usage[region].peak, g_user_mem_usage[region].size);
+    }
+}
@@ -0,0 +1,107 @@
+/**
+ *****************************************************************************************
+ *
+ * @file user_mem.h
+ *
+ * @brief Stack and BLE heap high-water mark API.
+ *
+ *****************************************************************************************
+ * @attention
+  #####Copyright (c) 2019 GOODIX
+  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of GOODIX nor the names of its contributors may be used
+    to endorse or promote products derived from this software without
+    specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************************
+ */
+#ifndef __USER_MEM_H__
+#define __USER_MEM_H__
+
+/*
+ * INCLUDE FILES
+ *****************************************************************************************
+ */
+#include "gr_includes.h"
+
+/*
+ * DEFINES
+ *****************************************************************************************
+ */
+#define USER_MEM_PAINT              0xDEADBEEF  /**< Fill of memory never used since boot. */
+#define USER_MEM_STACK_MARGIN       64          /**< Bytes below the current stack pointer left unpainted at boot. */
+
+/*
+ * TYPEDEFS
+ *****************************************************************************************
+ */
+/**@brief Monitored regions. The non-retention heap is left out, its content does not survive sleep. */
+typedef enum
+{
+    USER_MEM_STACK,             /**< Main stack, SYSTEM_STACK_SIZE bytes below the initial stack pointer. */
+    USER_MEM_ENV_HEAP,          /**< BLE stack environment heap of STACK_HEAP_INIT(). */
+    USER_MEM_MSG_HEAP,          /**< BLE stack message heap of STACK_HEAP_INIT(). */
+    USER_MEM_REGION_NB,
+} user_mem_region_t;
+
+/**@brief Usage of one region, in bytes. */
+typedef struct
+{
+    uint32_t size;
+    uint32_t peak;              /**< Bytes written since boot, an upper bound of the peak use of a heap. */
+} user_mem_usage_t;
+
+/*
+ * GLOBAL VARIABLE DECLARATIONS
+ *****************************************************************************************
+ */
+/**@brief Last result of user_mem_dump(), to be read from a debugger. */
+extern user_mem_usage_t g_user_mem_usage[USER_MEM_REGION_NB];
+
+/*
+ * GLOBAL FUNCTION DECLARATION
+ *****************************************************************************************
+ */
+/**
+ *****************************************************************************************
+ * @brief Paint the unused stack and the BLE stack heaps, call before ble_stack_init().
+ *
+ * @param[in] p_heaps: Heaps table passed to ble_stack_init().
+ *****************************************************************************************
+ */
+void user_mem_paint(const stack_heaps_table_t *p_heaps);
+
+/**
+ *****************************************************************************************
+ * @brief Scan a region for its high-water mark.
+ *****************************************************************************************
+ */
+void user_mem_usage_get(user_mem_region_t region, user_mem_usage_t *p_usage);
+
+/**
+ *****************************************************************************************
+ * @brief Refresh g_user_mem_usage and print it to the log.
+ *****************************************************************************************
+ */
+void user_mem_dump(void);
+
+#endif
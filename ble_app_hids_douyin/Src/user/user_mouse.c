@@ -45,6 +45,10 @@
 #include "app_log.h"
 #include "app_error.h"
 #include "utility.h"
+#include "user_latency.h"
+#include "user_stats.h"
+#include "user_conn_timeline.h"
+#include "user_link.h"
 
 /*
  * DEFINES
@@ -54,6 +58,7 @@
 #define HID_FINGER_REP_ID           2
 #define HID_MOUSE_REP_ID            4
 #define HID_MOUSE_XY_REP_ID         5
+#define HID_RES_MULT_REP_ID         6
 #define HID_COUNT_MAX_REP_ID        8
 
 #define INPUT_REPORT_COUNT          4
@@ -63,25 +68,58 @@
 #define HID_MOUSE_INDEX             2
 #define HID_MOUSE_XY_INDEX          3
 
+#define FEATURE_REPORT_COUNT        2
+
+#define HID_COUNT_MAX_INDEX         0
+#define HID_RES_MULT_INDEX          1
+
 #define BASE_USB_HID_SPEC_VERSION           0x0101        /**< Version number of base USB HID Specification implemented by this application. */
 
-#define HID_X_Y_SPEED                       300
+#define HID_CONTACT_COUNT_MAX               HID_FINGER_CONTACT_MAX /**< Default Contact Count Maximum feature value. */
+#define HID_CONTACT_ID_POOL_SIZE            8             /**< Contact ID 0 ~ 7, must match Logical Maximum of Contact Identifier in report map. */
+#define HID_CONTACT_COUNT_LIMIT             5             /**< Must match Logical Maximum of Contact Count Maximum in report map. */
+#define HID_CONTACT_ID_INVALID              0xFF
+#define HID_WHEEL_RES_MULT                  16            /**< Wheel/AC Pan resolution multiplier, must match Physical Maximum of Resolution Multiplier in report map. */
+#define HID_POINTER_HOME_X                  (-2047)       /**< Relative move that saturates the iOS pointer at the left edge. */
+#define HID_POINTER_HOME_Y                  2047          /**< Relative move that saturates the iOS pointer at the bottom edge. */
+#define HID_POINTER_STEP_MAX                2047          /**< Largest move of one 12-bit XY report. */
 #define BLE_CONN_EVT_SKIP_CNT               2
 #define BLE_SEND_DATA_INTVERL               1
 
 
+/*
+ * STRUCT DEFINE
+ *******************************************************************************
+ */
+/**@brief iOS pointer position, relative to the home corner. */
+typedef struct
+{
+    bool    homed;      /**< Position is known, cleared on (re)connect and host suspend. */
+    int16_t x;
+    int16_t y;
+} pointer_state_t;
+
 /*
  * LOCAL VARIABLE DEFINITIONS
  *******************************************************************************
  */
 
-static bool s_in_notify_enabled = false;
+static bool    s_in_notify_enabled = false;
+static int16_t s_wheel_res_mult    = 1;     /**< Wheel units per detent, HID_WHEEL_RES_MULT once the host enables high resolution scrolling. */
+static pointer_state_t s_pointer[CFG_MAX_CONNECTIONS];
+static uint16_t s_finger_scan_time = 0;     /**< Scan time of the last finger frame. */
+static uint8_t s_contact_id_used   = 0;     /**< Bit mask of contact IDs in use, an ID is freed once its lift has been reported. */
+static uint8_t s_contact_id_down   = 0;     /**< Bit mask of contact IDs the host has seen down. */
+static finger_contact_t s_contact_last[HID_CONTACT_ID_POOL_SIZE];  /**< Last reported state of every contact ID in use. */
+static mouse_data_t     s_mouse_last;        /**< Last reported buttons, wheel and pan are always sent as 0 afterwards. */
+static keyboard_data_t  s_keyboard_last;     /**< Last reported consumer keys. */
 
 /*
 This hid map include
 Phone Volume key :  take photo and control volume
 Mouse            :  control ios phone touch up,touch down,double touch
-Finger           :  control android phone touch up,touch down,double touch
+Finger           :  control android phone touch up,touch down,double touch,pinch
+                    (hybrid mode, HID_FINGER_CONTACT_MAX finger collections per report)
 */
 static const uint8_t rep_map_data[] =
 {
@@ -118,6 +156,41 @@ static const uint8_t rep_map_data[] =
     0x95, 0x06,        //     Report Count (6)
     0x81, 0x03,        //     Input (Const,Var,Abs,No Wrap,Linear,Preferred State,No Null Position)
     0x75, 0x08,        //     Report Size (8)
+    0x25, 0x07,        //     Logical Maximum (7)
+    0x09, 0x51,        //     Usage (0x51)
+    0x95, 0x01,        //     Report Count (1)
+    0x81, 0x02,        //     Input (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position)
+    0x05, 0x01,        //     Usage Page (Generic Desktop Ctrls)
+    0x26, 0xFF, 0x0F,  //     Logical Maximum (4095)
+    0x75, 0x10,        //     Report Size (16)
+    0x55, 0x0E,        //     Unit Exponent (-2)
+    0x65, 0x33,        //     Unit (System: English Linear, Length: Inch)
+    0x09, 0x30,        //     Usage (X)
+    0x35, 0x00,        //     Physical Minimum (0)
+    0x46, 0xB5, 0x04,  //     Physical Maximum (1205)
+    0x81, 0x02,        //     Input (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position)
+    0x46, 0x8A, 0x03,  //     Physical Maximum (906)
+    0x09, 0x31,        //     Usage (Y)
+    0x81, 0x02,        //     Input (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position)
+    0xC0,              //   End Collection
+    0x05, 0x0D,        //   Usage Page (Digitizer)
+    0x55, 0x00,        //   Unit Exponent (0)
+    0x65, 0x00,        //   Unit (None)
+    0x45, 0x00,        //   Physical Maximum (0)
+    0x09, 0x22,        //   Usage (Finger)
+    0xA1, 0x02,        //   Collection (Logical)
+    0x09, 0x42,        //     Usage (Tip Switch)
+    0x15, 0x00,        //     Logical Minimum (0)
+    0x25, 0x01,        //     Logical Maximum (1)
+    0x75, 0x01,        //     Report Size (1)
+    0x95, 0x01,        //     Report Count (1)
+    0x81, 0x02,        //     Input (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position)
+    0x09, 0x32,        //     Usage (In Range)
+    0x81, 0x02,        //     Input (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position)
+    0x95, 0x06,        //     Report Count (6)
+    0x81, 0x03,        //     Input (Const,Var,Abs,No Wrap,Linear,Preferred State,No Null Position)
+    0x75, 0x08,        //     Report Size (8)
+    0x25, 0x07,        //     Logical Maximum (7)
     0x09, 0x51,        //     Usage (0x51)
     0x95, 0x01,        //     Report Count (1)
     0x81, 0x02,        //     Input (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position)
@@ -135,6 +208,18 @@ static const uint8_t rep_map_data[] =
     0x81, 0x02,        //     Input (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position)
     0xC0,              //   End Collection
     0x05, 0x0D,        //   Usage Page (Digitizer)
+    0x55, 0x0C,        //   Unit Exponent (-4)
+    0x66, 0x01, 0x10,  //   Unit (System: SI Linear, Time: Seconds)
+    0x47, 0xFF, 0xFF, 0x00, 0x00,  //   Physical Maximum (65535)
+    0x27, 0xFF, 0xFF, 0x00, 0x00,  //   Logical Maximum (65535)
+    0x75, 0x10,        //   Report Size (16)
+    0x95, 0x01,        //   Report Count (1)
+    0x09, 0x56,        //   Usage (Scan Time)
+    0x81, 0x02,        //   Input (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position)
+    0x55, 0x00,        //   Unit Exponent (0)
+    0x65, 0x00,        //   Unit (None)
+    0x45, 0x00,        //   Physical Maximum (0)
+    0x25, 0x05,        //   Logical Maximum (5)
     0x09, 0x54,        //   Usage (0x54)
     0x95, 0x01,        //   Report Count (1)
     0x75, 0x08,        //   Report Size (8)
@@ -161,17 +246,32 @@ static const uint8_t rep_map_data[] =
     0x95, 0x01,        //     Report Count (1)
     0x75, 0x03,        //     Report Size (3)
     0x81, 0x01,        //     Input (Const,Array,Abs,No Wrap,Linear,Preferred State,No Null Position)
-    0x75, 0x08,        //     Report Size (8)
-    0x95, 0x01,        //     Report Count (1)
     0x05, 0x01,        //     Usage Page (Generic Desktop Ctrls)
-    0x09, 0x38,        //     Usage (Wheel)
-    0x15, 0x81,        //     Logical Minimum (-127)
-    0x25, 0x7F,        //     Logical Maximum (127)
-    0x81, 0x06,        //     Input (Data,Var,Rel,No Wrap,Linear,Preferred State,No Null Position)
-    0x05, 0x0C,        //     Usage Page (Consumer)
-    0x0A, 0x38, 0x02,  //     Usage (AC Pan)
-    0x95, 0x01,        //     Report Count (1)
-    0x81, 0x06,        //     Input (Data,Var,Rel,No Wrap,Linear,Preferred State,No Null Position)
+    0xA1, 0x02,        //     Collection (Logical)
+    0x85, 0x06,        //       Report ID (6)
+    0x09, 0x48,        //       Usage (Resolution Multiplier)
+    0x15, 0x00,        //       Logical Minimum (0)
+    0x25, 0x01,        //       Logical Maximum (1)
+    0x35, 0x01,        //       Physical Minimum (1)
+    0x45, 0x10,        //       Physical Maximum (16)
+    0x75, 0x02,        //       Report Size (2)
+    0x95, 0x01,        //       Report Count (1)
+    0xB1, 0x02,        //       Feature (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
+    0x75, 0x06,        //       Report Size (6)
+    0xB1, 0x03,        //       Feature (Const,Var,Abs,No Wrap,Linear,Preferred State,No Null Position,Non-volatile)
+    0x85, 0x04,        //       Report ID (4)
+    0x35, 0x00,        //       Physical Minimum (0)
+    0x45, 0x00,        //       Physical Maximum (0)
+    0x16, 0x01, 0x80,  //       Logical Minimum (-32767)
+    0x26, 0xFF, 0x7F,  //       Logical Maximum (32767)
+    0x75, 0x10,        //       Report Size (16)
+    0x95, 0x01,        //       Report Count (1)
+    0x09, 0x38,        //       Usage (Wheel)
+    0x81, 0x06,        //       Input (Data,Var,Rel,No Wrap,Linear,Preferred State,No Null Position)
+    0x05, 0x0C,        //       Usage Page (Consumer)
+    0x0A, 0x38, 0x02,  //       Usage (AC Pan)
+    0x81, 0x06,        //       Input (Data,Var,Rel,No Wrap,Linear,Preferred State,No Null Position)
+    0xC0,              //     End Collection
     0xC0,              //   End Collection
     0x85, 0x05,        //   Report ID (5)
     0x09, 0x01,        //   Usage (Consumer Control)
@@ -192,6 +292,19 @@ static const uint8_t rep_map_data[] =
  * LOCAL FUNCTION DEFINITIONS
  *******************************************************************************
  */
+/**
+ *****************************************************************************************
+ * @brief Forget every contact and key held, once the host no longer listens.
+ *****************************************************************************************
+ */
+static void mouse_held_clear(void)
+{
+    s_contact_id_used = 0;
+    s_contact_id_down = 0;
+    memset(&s_mouse_last, 0, sizeof(s_mouse_last));
+    memset(&s_keyboard_last, 0, sizeof(s_keyboard_last));
+}
+
 /**
  *****************************************************************************************
  * @brief Process HID Service events.
@@ -215,6 +328,22 @@ static void hid_service_event_process(hids_evt_t *p_evt)
 
         case HIDS_EVT_IN_REP_NOTIFY_DISABLED:
             s_in_notify_enabled = false;
+            // Nothing can be released any more, the host drops its input state too.
+            mouse_held_clear();
+            break;
+
+        case HIDS_EVT_HOST_SUSP:
+        case HIDS_EVT_HOST_EXIT_SUSP:
+            // The host may move or re-center the pointer while suspended.
+            user_mouse_pointer_invalidate(p_evt->conn_idx);
+            break;
+
+        case HIDS_EVT_REP_CHAR_WRITE:
+            if (HIDS_REPORT_TYPE_FEATURE2 == p_evt->report_type && p_evt->len)
+            {
+                s_wheel_res_mult = (p_evt->data[0] & 0x03) ? HID_WHEEL_RES_MULT : 1;
+                APP_LOG_INFO("Wheel resolution multiplier: %d", s_wheel_res_mult);
+            }
             break;
 
         default:
@@ -262,11 +391,19 @@ static void user_hids_init(void)
     hids_init.input_report_array[HID_MOUSE_XY_INDEX].ref.report_id     = HID_MOUSE_XY_REP_ID;
     hids_init.input_report_array[HID_MOUSE_XY_INDEX].ref.report_type   = HIDS_REP_TYPE_INPUT;
 
-    uint8_t count_max = 1;
-    hids_init.count_max_feat_report.value_len       = sizeof(count_max);
-    hids_init.count_max_feat_report.ref.report_id   = HID_COUNT_MAX_REP_ID;
-    hids_init.count_max_feat_report.ref.report_type = HIDS_REP_TYPE_FEATURE;
-    memcpy(hids_init.count_max_feat, &count_max, sizeof(count_max));
+    hids_init.feature_report_count                                     = FEATURE_REPORT_COUNT;
+
+    uint8_t count_max = HID_CONTACT_COUNT_MAX;
+    hids_init.feature_report_array[HID_COUNT_MAX_INDEX].value_len       = sizeof(count_max);
+    hids_init.feature_report_array[HID_COUNT_MAX_INDEX].ref.report_id   = HID_COUNT_MAX_REP_ID;
+    hids_init.feature_report_array[HID_COUNT_MAX_INDEX].ref.report_type = HIDS_REP_TYPE_FEATURE;
+    memcpy(hids_init.feature_report_val[HID_COUNT_MAX_INDEX], &count_max, sizeof(count_max));
+
+    // Resolution Multiplier defaults to 0 (one wheel unit per detent) until the host enables it.
+    hids_init.feature_report_array[HID_RES_MULT_INDEX].value_len        = sizeof(uint8_t);
+    hids_init.feature_report_array[HID_RES_MULT_INDEX].ref.report_id    = HID_RES_MULT_REP_ID;
+    hids_init.feature_report_array[HID_RES_MULT_INDEX].ref.report_type  = HIDS_REP_TYPE_FEATURE;
+    hids_init.feature_report_val[HID_RES_MULT_INDEX][0]                  = 0;
 
     sdk_err_t  ret = hids_service_init(&hids_init);
 }
@@ -280,216 +417,307 @@ void user_mouse_service_init(void)
     user_hids_init();
 }
 
+void user_mouse_pointer_invalidate(uint8_t conn_idx)
+{
+    if (conn_idx < CFG_MAX_CONNECTIONS)
+    {
+        s_pointer[conn_idx].homed = false;
+    }
+}
+
+void user_mouse_disconnected(uint8_t conn_idx)
+{
+    uint8_t res_mult = 0;
+
+    user_mouse_pointer_invalidate(conn_idx);
+    // The host let go of everything with the link.
+    mouse_held_clear();
+    // The next host starts from one wheel unit per detent until it enables high resolution.
+    s_wheel_res_mult = 1;
+    hids_feature_rep_set(HID_RES_MULT_INDEX, &res_mult, sizeof(res_mult));
+}
 
-//static sdk_err_t user_keyboard_data_send(uint8_t conn_idx, keyboard_data_t *p_data)
-//{
-//    sdk_err_t err_code;
-//    if (s_in_notify_enabled)
-//    {
-//        err_code = hids_input_rep_send(conn_idx,HID_KEYBOARD_INDEX,(uint8_t*)p_data, sizeof(keyboard_data_t));
-//    }
-//    return err_code;
-//}
+sdk_err_t user_mouse_contact_count_max_set(uint8_t count_max)
+{
+    if (count_max == 0 || count_max > HID_CONTACT_COUNT_LIMIT || count_max > HID_CONTACT_ID_POOL_SIZE)
+    {
+        return SDK_ERR_INVALID_PARAM;
+    }
+    return hids_feature_rep_set(HID_COUNT_MAX_INDEX, &count_max, sizeof(count_max));
+}
 
-static sdk_err_t user_finger_data_send(uint8_t conn_idx, finger_data_t *p_data)
+
+/**
+ *****************************************************************************************
+ * @brief Send one input report and account it, SDK_ERR_NTF_DISABLED until the host
+ *        enables notifications.
+ *****************************************************************************************
+ */
+static sdk_err_t user_input_report_send(uint8_t conn_idx, uint8_t rep_idx, void *p_data, uint16_t length)
 {
     sdk_err_t err_code;
-    if (s_in_notify_enabled)
+
+    if (!s_in_notify_enabled)
     {
-        err_code = hids_input_rep_send(conn_idx,HID_FINGER_INDEX,(uint8_t*)p_data, sizeof(finger_data_t));
+        user_latency_abort();
+        return SDK_ERR_NTF_DISABLED;
     }
-    
+
+    err_code = hids_input_rep_send(conn_idx, rep_idx, (uint8_t *)p_data, length);
+    if (SDK_SUCCESS == err_code)
+    {
+        user_latency_report_queued();
+        user_stats_report_sent();
+        user_conn_timeline_mark(conn_idx, CONN_PHASE_FIRST_REPORT, 0);
+    }
+    else
+    {
+        user_stats_report_failed(err_code);
+        user_latency_report_refused();
+    }
+    user_link_report_result(conn_idx, err_code);
     return err_code;
 }
 
+static sdk_err_t user_keyboard_data_send(uint8_t conn_idx, keyboard_data_t *p_data)
+{
+    return user_input_report_send(conn_idx, HID_KEYBOARD_INDEX, p_data, sizeof(keyboard_data_t));
+}
+
 static sdk_err_t user_mouse_data_send(uint8_t conn_idx, mouse_data_t *p_data)
 {
-    sdk_err_t err_code;
-    if (s_in_notify_enabled)
+    return user_input_report_send(conn_idx, HID_MOUSE_INDEX, p_data, sizeof(mouse_data_t));
+}
+
+static sdk_err_t user_mouse_xy_data_send(uint8_t conn_idx, mouse_xy_data_t *p_data)
+{
+    return user_input_report_send(conn_idx, HID_MOUSE_XY_INDEX, p_data, sizeof(mouse_xy_data_t));
+}
+
+static sdk_err_t user_finger_data_send(uint8_t conn_idx, finger_data_t *p_data)
+{
+    return user_input_report_send(conn_idx, HID_FINGER_INDEX, p_data, sizeof(finger_data_t));
+}
+
+/**
+ *****************************************************************************************
+ * @brief Allocate the lowest free contact ID.
+ *
+ * @return Contact ID, HID_CONTACT_ID_INVALID if all IDs are in use.
+ *****************************************************************************************
+ */
+static uint8_t finger_contact_id_alloc(void)
+{
+    for (uint8_t id = 0; id < HID_CONTACT_ID_POOL_SIZE; id++)
+    {
+        if (!(s_contact_id_used & (1 << id)))
+        {
+            s_contact_id_used |= (1 << id);
+            return id;
+        }
+    }
+    return HID_CONTACT_ID_INVALID;
+}
+
+bool user_mouse_pointer_step(uint8_t conn_idx, int16_t x, int16_t y)
+{
+    pointer_state_t *p_pointer     = &s_pointer[conn_idx];
+    mouse_xy_data_t  mouse_xy_data = {0};
+    sdk_err_t        err_code;
+    int16_t          dx;
+    int16_t          dy;
+
+    // The model only follows reports the stack took, a refused one is retried on the next step.
+    if (!p_pointer->homed)
+    {
+        mouse_xy_data.x = HID_POINTER_HOME_X;
+        mouse_xy_data.y = HID_POINTER_HOME_Y;
+        err_code = user_mouse_xy_data_send(conn_idx, &mouse_xy_data);
+        if (SDK_SUCCESS == err_code)
+        {
+            p_pointer->homed = true;
+            p_pointer->x     = 0;
+            p_pointer->y     = 0;
+        }
+        return (SDK_SUCCESS == err_code || SDK_ERR_NO_RESOURCES == err_code);
+    }
+
+    if (p_pointer->x == x && p_pointer->y == y)
+    {
+        return false;
+    }
+
+    dx = x - p_pointer->x;
+    dy = y - p_pointer->y;
+    dx = (dx > HID_POINTER_STEP_MAX) ? HID_POINTER_STEP_MAX : ((dx < -HID_POINTER_STEP_MAX) ? -HID_POINTER_STEP_MAX : dx);
+    dy = (dy > HID_POINTER_STEP_MAX) ? HID_POINTER_STEP_MAX : ((dy < -HID_POINTER_STEP_MAX) ? -HID_POINTER_STEP_MAX : dy);
+    mouse_xy_data.x = dx;
+    mouse_xy_data.y = dy;
+    err_code = user_mouse_xy_data_send(conn_idx, &mouse_xy_data);
+    if (SDK_SUCCESS == err_code)
+    {
+        p_pointer->x += dx;
+        p_pointer->y += dy;
+    }
+
+    return (SDK_SUCCESS == err_code || SDK_ERR_NO_RESOURCES == err_code);
+}
+
+sdk_err_t user_mouse_scroll_send(uint8_t conn_idx, int16_t wheel, int16_t pan)
+{
+    mouse_data_t mouse_data = s_mouse_last;
+
+    mouse_data.wheel_delta = wheel * s_wheel_res_mult;
+    mouse_data.ac_delta    = pan * s_wheel_res_mult;
+    return user_mouse_data_send(conn_idx, &mouse_data);
+}
+
+sdk_err_t user_mouse_button_send(uint8_t conn_idx, bool pressed)
+{
+    mouse_data_t mouse_data = s_mouse_last;
+    sdk_err_t    err_code;
+
+    mouse_data.left_button = pressed ? 1 : 0;
+    err_code = user_mouse_data_send(conn_idx, &mouse_data);
+    if (SDK_SUCCESS == err_code)
     {
-        err_code = hids_input_rep_send(conn_idx,HID_MOUSE_INDEX,(uint8_t*)p_data, sizeof(mouse_data_t));
+        s_mouse_last = mouse_data;
     }
     return err_code;
 }
 
-static sdk_err_t user_mouse_xy_data_send(uint8_t conn_idx, mouse_xy_data_t *p_data)
+sdk_err_t user_mouse_volume_send(uint8_t conn_idx, bool pressed)
 {
-    sdk_err_t err_code;
-    if (s_in_notify_enabled)
+    keyboard_data_t keyboard_data = s_keyboard_last;
+    sdk_err_t       err_code;
+
+    keyboard_data.volume_increment = pressed ? 1 : 0;
+    err_code = user_keyboard_data_send(conn_idx, &keyboard_data);
+    if (SDK_SUCCESS == err_code)
     {
-        err_code = hids_input_rep_send(conn_idx,HID_MOUSE_XY_INDEX,(uint8_t*)p_data, sizeof(mouse_xy_data_t));
+        s_keyboard_last = keyboard_data;
     }
     return err_code;
 }
 
-void touch_up(bool is_ios)
+sdk_err_t user_finger_contact_down(finger_contact_t *p_contact, uint16_t x, uint16_t y)
 {
-    finger_data_t finger_data = {0};
-    mouse_data_t  mouse_data = {0};
-    mouse_xy_data_t mouse_xy_data = {0};
-    APP_LOG_INFO("touch up, check iOS platform : %s",is_ios ? "true" : "false");
-    if (is_ios)
+    memset(p_contact, 0, sizeof(*p_contact));
+    p_contact->contact_id = finger_contact_id_alloc();
+    if (HID_CONTACT_ID_INVALID == p_contact->contact_id)
     {
-        mouse_xy_data.x = -2047;
-        mouse_xy_data.y = 2047;
-        user_mouse_xy_data_send(0, &mouse_xy_data);
-        delay_ms(DELAY_FOR_EVERY_ACTION);
-        mouse_xy_data.x = 80;
-        mouse_xy_data.y = -120;
-        user_mouse_xy_data_send(0, &mouse_xy_data);
-        delay_ms(DELAY_FOR_EVERY_ACTION);
-        mouse_data.wheel_delta = 120;
-        user_mouse_data_send(0, &mouse_data);
-        delay_ms(DELAY_FOR_EVERY_ACTION);
-        user_mouse_data_send(0, &mouse_data);
-        delay_ms(DELAY_FOR_EVERY_ACTION);
-        user_mouse_data_send(0, &mouse_data);
-        delay_ms(DELAY_FOR_EVERY_ACTION);
-        mouse_xy_data.x = -2047;
-        mouse_xy_data.y = 2047;
-        user_mouse_xy_data_send(0, &mouse_xy_data);
+        APP_LOG_WARNING("No free contact ID.");
+        return SDK_ERR_NO_RESOURCES;
     }
-    else
+    p_contact->tip_switch = 1;
+    p_contact->in_range   = 1;
+    p_contact->x_data     = x;
+    p_contact->y_data     = y;
+
+    return SDK_SUCCESS;
+}
+
+void user_finger_contact_cancel(finger_contact_t *p_contact)
+{
+    if (p_contact->contact_id < HID_CONTACT_ID_POOL_SIZE)
     {
-        finger_data.tip_switch  = 1;
-        finger_data.in_range    = 1;
-        finger_data.contact_id  = 6;
-        finger_data.contact_cnt = 1;
-        finger_data.x_data      = 1904;
-        finger_data.y_data      = 3200;
-        user_finger_data_send(0, &finger_data);
-        delay_ms(DELAY_FOR_EVERY_ACTION);
-        finger_data.y_data      = 2600;
-        for (uint8_t i = 0; i < 8; i++)
-        {
-            user_finger_data_send(0, &finger_data);
-            delay_ms(DELAY_FOR_EVERY_ACTION);
-            finger_data.y_data -= HID_X_Y_SPEED;
-        }
-        finger_data.x_data      = 1904;
-        finger_data.y_data      = 3200;
-        finger_data.tip_switch  = 0;
-        finger_data.in_range    = 0;
-        finger_data.contact_cnt = 0;
-        user_finger_data_send(0, &finger_data);
+        s_contact_id_used &= ~(1 << p_contact->contact_id);
     }
+    memset(p_contact, 0, sizeof(*p_contact));
+    p_contact->contact_id = HID_CONTACT_ID_INVALID;
+}
+
+void user_finger_contact_up(finger_contact_t *p_contact)
+{
+    p_contact->tip_switch = 0;
+    p_contact->in_range   = 0;
 }
 
-void touch_down(bool is_ios)
+sdk_err_t user_finger_frame_send(uint8_t conn_idx, finger_contact_t *p_contacts, uint8_t num, uint16_t scan_time)
 {
-    finger_data_t finger_data = {0};
-    mouse_data_t  mouse_data = {0};
-    mouse_xy_data_t mouse_xy_data = {0};
-    APP_LOG_INFO("touch down, check iOS platform : %s",is_ios ? "true" : "false");
-    if (is_ios)
+    finger_data_t finger_data;
+    sdk_err_t     err_code = SDK_SUCCESS;
+    uint8_t       sent     = 0;
+
+    // Stop at the first refused report, the host must not see the rest of a partial frame.
+    while (sent < num)
     {
-        mouse_xy_data.x = -2047;
-        mouse_xy_data.y = 2047;
-        user_mouse_xy_data_send(0, &mouse_xy_data);
-        delay_ms(DELAY_FOR_EVERY_ACTION);
-        mouse_xy_data.x = 80;
-        mouse_xy_data.y = -120;
-        user_mouse_xy_data_send(0, &mouse_xy_data);
-        delay_ms(DELAY_FOR_EVERY_ACTION);
-        mouse_data.wheel_delta = -120;
-        user_mouse_data_send(0, &mouse_data);
-        delay_ms(DELAY_FOR_EVERY_ACTION);
-        user_mouse_data_send(0, &mouse_data);
-        delay_ms(DELAY_FOR_EVERY_ACTION);
-        user_mouse_data_send(0, &mouse_data);
-        delay_ms(DELAY_FOR_EVERY_ACTION);
-        mouse_xy_data.x = -2047;
-        mouse_xy_data.y = 2047;
-        user_mouse_xy_data_send(0, &mouse_xy_data);
+        uint8_t packed = (num - sent) < HID_FINGER_CONTACT_MAX ? (num - sent) : HID_FINGER_CONTACT_MAX;
+
+        memset(&finger_data, 0, sizeof(finger_data));
+        memcpy(finger_data.contact, &p_contacts[sent], packed * sizeof(finger_contact_t));
+        finger_data.scan_time   = scan_time;
+        finger_data.contact_cnt = sent ? 0 : num;
+        err_code = user_finger_data_send(conn_idx, &finger_data);
+        if (SDK_SUCCESS != err_code)
+        {
+            break;
+        }
+        sent += packed;
     }
-    else
+
+    // Only contacts the stack took change state, a refused lift keeps its ID in use
+    // unless the host never saw the contact down.
+    for (uint8_t i = 0; i < num; i++)
     {
-        finger_data.tip_switch  = 1;
-        finger_data.in_range    = 1;
-        finger_data.contact_id  = 6;
-        finger_data.contact_cnt = 1;
-        finger_data.x_data      = 1904;
-        finger_data.y_data      = 1012 ;
-        user_finger_data_send(0, &finger_data);
-        delay_ms(DELAY_FOR_EVERY_ACTION);
-        finger_data.y_data      = 1100;
-        for (uint8_t i = 0; i < 8; i++)
+        uint8_t id = p_contacts[i].contact_id;
+
+        if (id >= HID_CONTACT_ID_POOL_SIZE)
+        {
+            continue;
+        }
+        if (i < sent && p_contacts[i].tip_switch)
+        {
+            s_contact_last[id] = p_contacts[i];
+            s_contact_id_down |= (1 << id);
+        }
+        else if (!p_contacts[i].tip_switch && (i < sent || !(s_contact_id_down & (1 << id))))
         {
-            user_finger_data_send(0, &finger_data);
-            delay_ms(DELAY_FOR_EVERY_ACTION);
-            finger_data.y_data += HID_X_Y_SPEED;
+            s_contact_id_used &= ~(1 << id);
+            s_contact_id_down &= ~(1 << id);
         }
-        finger_data.x_data      = 1904;
-        finger_data.y_data      = 1012;
-        finger_data.tip_switch  = 0;
-        finger_data.in_range    = 0;
-        finger_data.contact_cnt = 0;
-        user_finger_data_send(0, &finger_data);
     }
+    if (sent)
+    {
+        s_finger_scan_time = scan_time;
+    }
+    return err_code;
 }
 
-void touch_double(bool is_ios)
+bool user_mouse_is_held(void)
 {
-    finger_data_t finger_data = {0};
-    mouse_data_t  mouse_data = {0};
-    mouse_xy_data_t mouse_xy_data = {0};
-    APP_LOG_INFO("touch double, check iOS platform : %s",is_ios ? "true" : "false");
-    if (is_ios)
+    return s_contact_id_used || s_mouse_last.left_button || s_keyboard_last.volume_increment;
+}
+
+bool user_mouse_release_all(uint8_t conn_idx)
+{
+    finger_contact_t contacts[HID_CONTACT_ID_POOL_SIZE];
+    uint8_t          num  = 0;
+    bool             sent = false;
+
+    // IDs taken by a gesture that never got its contact down are just given back.
+    s_contact_id_used &= s_contact_id_down;
+    for (uint8_t id = 0; id < HID_CONTACT_ID_POOL_SIZE; id++)
     {
-        mouse_xy_data.x = -2047;
-        mouse_xy_data.y = 2047;
-        user_mouse_xy_data_send(0, &mouse_xy_data);
-        delay_ms(DELAY_FOR_EVERY_ACTION);
-        mouse_xy_data.x = 120;
-        mouse_xy_data.y = -360;
-        user_mouse_xy_data_send(0, &mouse_xy_data);
-        delay_ms(DELAY_FOR_EVERY_ACTION*6);
-        mouse_data.left_button =1;
-        user_mouse_data_send(0, &mouse_data);
-        delay_ms(DELAY_FOR_EVERY_ACTION);
-        mouse_data.left_button =0;
-        user_mouse_data_send(0, &mouse_data);
-        delay_ms(DELAY_FOR_EVERY_ACTION*4);
-        mouse_data.left_button =1;
-        user_mouse_data_send(0, &mouse_data);
-        delay_ms(DELAY_FOR_EVERY_ACTION);
-        mouse_data.left_button =0;
-        user_mouse_data_send(0, &mouse_data);
-        delay_ms(DELAY_FOR_EVERY_ACTION*6);
-        mouse_xy_data.x = -2047;
-        mouse_xy_data.y = 2047;
-        user_mouse_xy_data_send(0, &mouse_xy_data);
+        if (s_contact_id_down & (1 << id))
+        {
+            contacts[num] = s_contact_last[id];
+            user_finger_contact_up(&contacts[num]);
+            num++;
+        }
     }
-    else
+    if (num && SDK_SUCCESS == user_finger_frame_send(conn_idx, contacts, num, s_finger_scan_time + HID_SCAN_TIME_PER_FRAME))
     {
-        finger_data.tip_switch  = 1;
-        finger_data.in_range    = 1;
-        finger_data.contact_id  = 6;
-        finger_data.contact_cnt = 1;
-        finger_data.x_data      = 1904;
-        finger_data.y_data      = 2024;
-        user_finger_data_send(0, &finger_data);
-        delay_ms(DELAY_FOR_EVERY_ACTION);
-        finger_data.x_data      = 1904;
-        finger_data.y_data      = 2024;
-        finger_data.tip_switch  = 0;
-        finger_data.in_range    = 0;
-        finger_data.contact_cnt = 0;
-        user_finger_data_send(0, &finger_data);
-        delay_ms(DELAY_FOR_EVERY_ACTION*4);
-        finger_data.tip_switch  = 1;
-        finger_data.in_range    = 1;
-        finger_data.contact_id  = 6;
-        finger_data.contact_cnt = 1;
-        finger_data.x_data      = 1904;
-        finger_data.y_data      = 2024;
-        user_finger_data_send(0, &finger_data);
-        delay_ms(DELAY_FOR_EVERY_ACTION);
-        finger_data.x_data      = 1904;
-        finger_data.y_data      = 2024;
-        finger_data.tip_switch  = 0;
-        finger_data.in_range    = 0;
-        finger_data.contact_cnt = 0;
-        user_finger_data_send(0, &finger_data);
+        sent = true;
     }
+    if (s_mouse_last.left_button && SDK_SUCCESS == user_mouse_button_send(conn_idx, false))
+    {
+        sent = true;
+    }
+    if (s_keyboard_last.volume_increment && SDK_SUCCESS == user_mouse_volume_send(conn_idx, false))
+    {
+        sent = true;
+    }
+
+    return sent;
 }
@@ -57,6 +57,8 @@
 #define CONN_SUP_TIMEOUT                    400                 /**< Connection supervisory timeout (4 seconds). */
 
 #define DELAY_FOR_EVERY_ACTION              15                 /**< Delay between every action ,15 = MIN_CONN_INTERVAL*1.25       */
+#define HID_SCAN_TIME_PER_FRAME             (DELAY_FOR_EVERY_ACTION * 10) /**< Scan time advance per frame, in 100 us units. */
+#define HID_FINGER_CONTACT_MAX              2                  /**< Contacts packed in one finger report, must match the finger collections in report map. */
  
 /**@brief Mouse input data define. */
 typedef struct
@@ -75,7 +77,13 @@ typedef struct
     uint8_t   contact_id;
     uint16_t  x_data;
     uint16_t  y_data;
-    uint8_t   contact_cnt;
+}__attribute__((packed)) finger_contact_t;
+
+typedef struct
+{
+    finger_contact_t contact[HID_FINGER_CONTACT_MAX];
+    uint16_t  scan_time;        /**< Time of the frame relative to finger down, in 100 us units. */
+    uint8_t   contact_cnt;      /**< Contacts of the whole frame in the first report, 0 in the following ones. */
 }__attribute__((packed)) finger_data_t;
 
 typedef struct
@@ -86,8 +94,8 @@ typedef struct
     uint8_t other1_button:1;
     uint8_t other2_button:1;
     uint8_t other_data:3;
-    int8_t  wheel_delta;
-    int8_t  ac_delta;
+    int16_t wheel_delta;        /**< Wheel travel, in 1/multiplier detent units. */
+    int16_t ac_delta;           /**< AC Pan travel, in 1/multiplier detent units. */
 }__attribute__((packed)) mouse_data_t;
 typedef struct
 {
@@ -105,13 +113,146 @@ typedef struct
  *****************************************************************************************
  */
 void user_mouse_service_init(void);
-void touch_up(bool is_andorid);
-void touch_down(bool is_andorid);
-void touch_double(bool is_ios);
-void touch_right(bool is_andorid);
-void touch_left(bool is_andorid);
-void touch_func(bool is_andorid);
-void touch_camera(void);
+
+/**
+ *****************************************************************************************
+ * @brief Forget the iOS pointer position, the next gesture homes the pointer first.
+ *
+ * @param[in] conn_idx: Connection index.
+ *****************************************************************************************
+ */
+void user_mouse_pointer_invalidate(uint8_t conn_idx);
+
+/**
+ *****************************************************************************************
+ * @brief Forget the state of the host on a link that went down: pointer position, wheel
+ *        resolution multiplier and the contacts and keys held.
+ *
+ * @param[in] conn_idx: Connection index.
+ *****************************************************************************************
+ */
+void user_mouse_disconnected(uint8_t conn_idx);
+
+/**
+ *****************************************************************************************
+ * @brief Update the Contact Count Maximum feature report read by the host.
+ *
+ * @param[in] count_max: Maximum number of contacts, 1 ~ 5.
+ *
+ * @return Result of updating the feature report, SDK_ERR_INVALID_PARAM if count_max is out of range.
+ *****************************************************************************************
+ */
+sdk_err_t user_mouse_contact_count_max_set(uint8_t count_max);
+
+/**
+ *****************************************************************************************
+ * @brief Move the iOS pointer one report toward a position relative to the home corner.
+ *
+ * @details The pointer is homed first only when its position is unknown, otherwise
+ *          only the delta to the target is sent, at most 12 bits per report.
+ *
+ * @param[in] conn_idx: Connection index.
+ * @param[in] x:        Target X, relative to the home corner.
+ * @param[in] y:        Target Y, relative to the home corner.
+ *
+ * @return true if a report was sent or refused for lack of buffers, call again on the next
+ *         step. false if the pointer is already on target or cannot be moved at all.
+ *****************************************************************************************
+ */
+bool user_mouse_pointer_step(uint8_t conn_idx, int16_t x, int16_t y);
+
+/**
+ *****************************************************************************************
+ * @brief Send one wheel and AC Pan report, scaled by the host resolution multiplier.
+ *
+ * @param[in] conn_idx: Connection index.
+ * @param[in] wheel:    Wheel travel, in detent units.
+ * @param[in] pan:      AC Pan travel, in detent units.
+ *
+ * @return Result of hids_input_rep_send(), the scroll is lost unless it is sent again.
+ *****************************************************************************************
+ */
+sdk_err_t user_mouse_scroll_send(uint8_t conn_idx, int16_t wheel, int16_t pan);
+
+/**
+ *****************************************************************************************
+ * @brief Press or release the left mouse button, the button state changes only if the
+ *        report is queued.
+ *****************************************************************************************
+ */
+sdk_err_t user_mouse_button_send(uint8_t conn_idx, bool pressed);
+
+/**
+ *****************************************************************************************
+ * @brief Press or release the consumer Volume Increment key, the key state changes only if
+ *        the report is queued.
+ *****************************************************************************************
+ */
+sdk_err_t user_mouse_volume_send(uint8_t conn_idx, bool pressed);
+
+/**
+ *****************************************************************************************
+ * @brief Put a contact down at the given position, with the lowest free contact ID.
+ *
+ * @return SDK_ERR_NO_RESOURCES if every contact ID is in use, the contact is left up
+ *         and must not be sent.
+ *****************************************************************************************
+ */
+sdk_err_t user_finger_contact_down(finger_contact_t *p_contact, uint16_t x, uint16_t y);
+
+/**
+ *****************************************************************************************
+ * @brief Give back the ID of a contact put down but never sent.
+ *****************************************************************************************
+ */
+void user_finger_contact_cancel(finger_contact_t *p_contact);
+
+/**
+ *****************************************************************************************
+ * @brief Mark a contact as lifting, it is released once the next frame has been sent.
+ *****************************************************************************************
+ */
+void user_finger_contact_up(finger_contact_t *p_contact);
+
+/**
+ *****************************************************************************************
+ * @brief Send one frame of contacts in hybrid mode.
+ *
+ * @details Contacts are packed HID_FINGER_CONTACT_MAX per report, the first report of
+ *          the frame carries the contact count of the whole frame and the following
+ *          ones carry 0. A contact whose tip switch is cleared is reported once more
+ *          and its ID is released for the next contact.
+ *
+ * @param[in] conn_idx:   Connection index.
+ * @param[in] p_contacts: Contacts of the frame, down or lifting in this frame.
+ * @param[in] num:        Number of contacts.
+ * @param[in] scan_time:  Time of the frame relative to the first contact down, in 100 us units.
+ *
+ * @return Error of the first refused report. Contacts from that report on keep their
+ *         previous state, a lifting one keeps its ID until its lift is sent.
+ *****************************************************************************************
+ */
+sdk_err_t user_finger_frame_send(uint8_t conn_idx, finger_contact_t *p_contacts, uint8_t num, uint16_t scan_time);
+
+/**
+ *****************************************************************************************
+ * @brief Release everything still held on the host: lift all contacts in use and
+ *        release the mouse button and consumer key. Nothing is sent if nothing is held.
+ *
+ * @param[in] conn_idx: Connection index.
+ *
+ * @return true if any release report was queued. Whatever was refused stays held, call
+ *         again until user_mouse_is_held() returns false.
+ *****************************************************************************************
+ */
+bool user_mouse_release_all(uint8_t conn_idx);
+
+/**
+ *****************************************************************************************
+ * @brief Check whether a contact, the mouse button or the consumer key is held on the host.
+ *****************************************************************************************
+ */
+bool user_mouse_is_held(void);
 
 #endif
 
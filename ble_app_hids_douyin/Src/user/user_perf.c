@@ -0,0 +1,186 @@
+/**
+ *****************************************************************************************
+ *
+ * @file user_perf.c
+ *
+ * @brief Cycle counter based timing implementation.
+ *
+ *****************************************************************************************
+ * @attention
+  #####Copyright (c) 2019 GOODIX
+  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of GOODIX nor the names of its contributors may be used
+    to endorse or promote products derived from this software without
+    specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************************
+ */
+/*
+ * INCLUDE FILES
+ *****************************************************************************************
+ */
+#include "user_perf.h"
+#include "app_log.h"
+#include "app_pwr_mgmt.h"
+#include <string.h>
+
+/*
+ * LOCAL VARIABLE DEFINITIONS
+ *****************************************************************************************
+ */
+static uint32_t       s_perf_sleep_cycles;
+static uint32_t       s_perf_us;            /**< Awake time folded in so far. */
+static uint32_t       s_perf_us_cycles;     /**< Cycle counter at the last fold. */
+#if USER_PROFILE_ENABLE
+static profile_stat_t s_profile[PROFILE_SITE_NB];
+#endif
+
+/*
+ * LOCAL FUNCTION DEFINITIONS
+ *****************************************************************************************
+ */
+static void perf_counter_enable(uint32_t cycles)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT       = cycles;
+    DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static bool perf_sleep_enter(void)
+{
+    s_perf_sleep_cycles = USER_PERF_CYCLES();
+
+    return true;
+}
+
+static void perf_sleep_canceled(void)
+{
+    // The core did not sleep, the counter kept running.
+}
+
+static void perf_wake_up(void)
+{
+    perf_counter_enable(s_perf_sleep_cycles);
+}
+
+static const app_sleep_callbacks_t s_perf_sleep_cb =
+{
+    .app_prepare_for_sleep = perf_sleep_enter,
+    .app_sleep_canceled    = perf_sleep_canceled,
+    .app_wake_up_ind       = perf_wake_up,
+};
+
+/*
+ * GLOBAL FUNCTION DEFINITIONS
+ *****************************************************************************************
+ */
+void user_perf_init(void)
+{
+    s_perf_us        = 0;
+    s_perf_us_cycles = 0;
+    perf_counter_enable(0);
+    // Registered before the other sleep callbacks, so the counter runs again when they trace the wake up.
+    pwr_register_sleep_cb(&s_perf_sleep_cb, WAPEUP_PRIORITY_LOW);
+}
+
+uint32_t user_perf_now_us(void)
+{
+    uint32_t mhz = SystemCoreClock / 1000000;
+    uint32_t us;
+
+    GLOBAL_EXCEPTION_DISABLE();
+    us                = (USER_PERF_CYCLES() - s_perf_us_cycles) / mhz;
+    // The remainder stays in the counter span for the next fold.
+    s_perf_us_cycles += us * mhz;
+    s_perf_us        += us;
+    us                = s_perf_us;
+    GLOBAL_EXCEPTION_ENABLE();
+
+    return us;
+}
+
+void user_perf_profile_add(profile_site_t site, uint32_t cycles)
+{
+#if USER_PROFILE_ENABLE
+    profile_stat_t *p_stat = &s_profile[site];
+
+    GLOBAL_EXCEPTION_DISABLE();
+    if (p_stat->count == 0 || cycles < p_stat->min)
+    {
+        p_stat->min = cycles;
+    }
+    if (cycles > p_stat->max)
+    {
+        p_stat->max = cycles;
+    }
+    p_stat->count++;
+    p_stat->total += cycles;
+    GLOBAL_EXCEPTION_ENABLE();
+#endif
+}
+
+void user_perf_profile_get(profile_site_t site, profile_stat_t *p_stat)
+{
+#if USER_PROFILE_ENABLE
+    GLOBAL_EXCEPTION_DISABLE();
+    *p_stat = s_profile[site];
+    GLOBAL_EXCEPTION_ENABLE();
+#else
+    memset(p_stat, 0, sizeof(profile_stat_t));
+#endif
+}
+
+void user_perf_profile_dump(void)
+{
+#if USER_PROFILE_ENABLE
+    static const char *const s_site_name[PROFILE_SITE_GESTURE_STEP] = {"ble_evt", "hids_evt", "rep_send"};
+    profile_stat_t stat;
+
+    for (uint8_t site = 0; site < PROFILE_SITE_NB; site++)
+    {
+        user_perf_profile_get((profile_site_t)site, &stat);
+        if (stat.count == 0)
+        {
+            continue;
+        }
+        if (site < PROFILE_SITE_GESTURE_STEP)
+        {
+            APP_LOG_INFO("Profile %s: n %d, cycles min %d avg %d max %d", s_site_name[site], stat.count,
+                         stat.min, (uint32_t)(stat.total / stat.count), stat.max);
+        }
+        else
+        {
+            APP_LOG_INFO("Profile gesture %d step: n %d, cycles min %d avg %d max %d", site - PROFILE_SITE_GESTURE_STEP,
+                         stat.count, stat.min, (uint32_t)(stat.total / stat.count), stat.max);
+        }
+    }
+#endif
+}
+
+void user_perf_profile_reset(void)
+{
+#if USER_PROFILE_ENABLE
+    GLOBAL_EXCEPTION_DISABLE();
+    memset(s_profile, 0, sizeof(s_profile));
+    GLOBAL_EXCEPTION_ENABLE();
+#endif
+}
@@ -0,0 +1,158 @@
+/**
+ *****************************************************************************************
+ *
+ * @file user_perf.h
+ *
+ * @brief Cycle counter based timing API.
+ *
+ *****************************************************************************************
+ * @attention
+  #####Copyright (c) 2019 GOODIX
+  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of GOODIX nor the names of its contributors may be used
+    to endorse or promote products derived from this software without
+    specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************************
+ */
+#ifndef __USER_PERF_H__
+#define __USER_PERF_H__
+
+/*
+ * INCLUDE FILES
+ *****************************************************************************************
+ */
+#include "gr_includes.h"
+
+/*
+ * DEFINES
+ *****************************************************************************************
+ */
+#ifndef USER_PROFILE_ENABLE
+#define USER_PROFILE_ENABLE                 0       /**< Time the profiled sites, 0 compiles the macros out. */
+#endif
+
+#define USER_PROFILE_GESTURE_NB             16      /**< Gesture step sites, one per gesture_type_t. */
+
+#ifndef USER_RAM_CODE_ENABLE
+#define USER_RAM_CODE_ENABLE                1       /**< Run the report path from RAM instead of XIP flash. */
+#endif
+
+/*
+ * MACROS
+ *****************************************************************************************
+ */
+/**@brief Current DWT cycle count, wraps every 2^32 / SystemCoreClock seconds (67 s at 64 MHz). */
+#define USER_PERF_CYCLES()                  (DWT->CYCCNT)
+
+/**@brief Place a function in RAM (RAM_CODE section, __ramfunc on IAR), keeping cache misses out of
+ *        the connection event. The RAM code budget is checked at link time. */
+#if USER_RAM_CODE_ENABLE
+#define USER_RAM_CODE                       SECTION_RAM_CODE
+#else
+#define USER_RAM_CODE
+#endif
+
+/**@brief Time a block: USER_PROFILE_START(start); ... USER_PROFILE_STOP(PROFILE_SITE_xxx, start); */
+#if USER_PROFILE_ENABLE
+#define USER_PROFILE_START(start)           uint32_t start = USER_PERF_CYCLES()
+#define USER_PROFILE_STOP(site, start)      user_perf_profile_add((site), USER_PERF_CYCLES() - (start))
+#else
+#define USER_PROFILE_START(start)
+#define USER_PROFILE_STOP(site, start)
+#endif
+
+/*
+ * TYPEDEFS
+ *****************************************************************************************
+ */
+/**@brief Profiled sites. */
+typedef enum
+{
+    PROFILE_SITE_BLE_EVT,                   /**< ble_evt_handler(). */
+    PROFILE_SITE_HIDS_BLE_EVT,              /**< hids_ble_evt_handler(). */
+    PROFILE_SITE_REPORT_SEND,               /**< hids_input_rep_send(). */
+    PROFILE_SITE_GESTURE_STEP,              /**< Step function of a gesture, plus gesture_type_t. */
+    PROFILE_SITE_NB = PROFILE_SITE_GESTURE_STEP + USER_PROFILE_GESTURE_NB,
+} profile_site_t;
+
+/**@brief Cycles spent in one site. */
+typedef struct
+{
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+} profile_stat_t;
+
+/*
+ * GLOBAL FUNCTION DECLARATION
+ *****************************************************************************************
+ */
+/**
+ *****************************************************************************************
+ * @brief Enable the DWT cycle counter. It stops in sleep and is resumed where it stopped
+ *        on wake up, so it counts awake time only.
+ *****************************************************************************************
+ */
+void user_perf_init(void);
+
+/**
+ *****************************************************************************************
+ * @brief Awake time in us. The cycles counted since the last call are folded in at the
+ *        core clock they ran at, so spans stay right across clock switches. Call it at
+ *        least once per cycle counter wrap, and right before every SystemCoreSetClock().
+ *        Callable from interrupt context.
+ *****************************************************************************************
+ */
+uint32_t user_perf_now_us(void);
+
+/**
+ *****************************************************************************************
+ * @brief Account one run of a site, callable from interrupt context. Use USER_PROFILE_STOP().
+ *****************************************************************************************
+ */
+void user_perf_profile_add(profile_site_t site, uint32_t cycles);
+
+/**
+ *****************************************************************************************
+ * @brief Get the cycle table of one site, all zero when profiling is disabled.
+ *****************************************************************************************
+ */
+void user_perf_profile_get(profile_site_t site, profile_stat_t *p_stat);
+
+/**
+ *****************************************************************************************
+ * @brief Print count and min/avg/max cycles of every site that ran to the log. Cycles, not
+ *        us, as a site may run at either core clock.
+ *****************************************************************************************
+ */
+void user_perf_profile_dump(void);
+
+/**
+ *****************************************************************************************
+ * @brief Clear all cycle tables.
+ *****************************************************************************************
+ */
+void user_perf_profile_reset(void);
+
+#endif
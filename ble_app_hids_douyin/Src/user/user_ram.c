@@ -0,0 +1,110 @@
+/**
+ *****************************************************************************************
+ *
+ * @file user_ram.c
+ *
+ * @brief RAM retention implementation.
+ *
+ *****************************************************************************************
+ * @attention
+  #####Copyright (c) 2019 GOODIX
+  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of GOODIX nor the names of its contributors may be used
+    to endorse or promote products derived from this software without
+    specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************************
+ */
+/*
+ * INCLUDE FILES
+ *****************************************************************************************
+ */
+#include "user_ram.h"
+#include "gr_includes.h"
+#include "app_pwr_mgmt.h"
+
+/*
+ * DEFINES
+ *****************************************************************************************
+ */
+/* The unretained sections only have their own bank aligned region in gcc_linker.lds, Keil and IAR
+ * place them with the other RAM data and keep every block retained. */
+#if USER_RAM_RETENTION_ENABLE && defined(__GNUC__) && !defined(__ARMCC_VERSION)
+#define RAM_RETENTION_SUPPORTED             1
+#else
+#define RAM_RETENTION_SUPPORTED             0
+#endif
+
+#if RAM_RETENTION_SUPPORTED
+/*
+ * LOCAL VARIABLE DEFINITIONS
+ *****************************************************************************************
+ */
+/**@brief Retained range from gcc_linker.lds: ROM reserved RAM, .data, .bss, heap and stack. */
+extern uint32_t __user_ram_ret_start__;
+extern uint32_t __user_ram_ret_end__;
+
+/*
+ * LOCAL FUNCTION DEFINITIONS
+ *****************************************************************************************
+ */
+static bool ram_sleep_enter(void)
+{
+    // Only the blocks of the retained range stay powered, the unretained sections and the unused
+    // RAM above the stack lose their content.
+    mem_pwr_mgmt_mode_set_from((uint32_t)&__user_ram_ret_start__, user_ram_retained_size());
+    return true;
+}
+
+static void ram_power_restore(void)
+{
+    mem_pwr_mgmt_mode_set(MEM_POWER_FULL_MODE);
+}
+
+static const app_sleep_callbacks_t s_ram_sleep_cb =
+{
+    .app_prepare_for_sleep = ram_sleep_enter,
+    .app_sleep_canceled    = ram_power_restore,
+    .app_wake_up_ind       = ram_power_restore,
+};
+#endif
+
+/*
+ * GLOBAL FUNCTION DEFINITIONS
+ *****************************************************************************************
+ */
+void user_ram_init(void)
+{
+#if RAM_RETENTION_SUPPORTED
+    // High priority, the blocks are back before the other wake up callbacks run.
+    pwr_register_sleep_cb(&s_ram_sleep_cb, WAPEUP_PRIORITY_HIGH);
+#endif
+}
+
+uint32_t user_ram_retained_size(void)
+{
+#if RAM_RETENTION_SUPPORTED
+    return (uint32_t)&__user_ram_ret_end__ - (uint32_t)&__user_ram_ret_start__;
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,92 @@
+/**
+ *****************************************************************************************
+ *
+ * @file user_ram.h
+ *
+ * @brief RAM retention classes, unretained RAM blocks are powered down in sleep.
+ *
+ *****************************************************************************************
+ * @attention
+  #####Copyright (c) 2019 GOODIX
+  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of GOODIX nor the names of its contributors may be used
+    to endorse or promote products derived from this software without
+    specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************************
+ */
+#ifndef __USER_RAM_H__
+#define __USER_RAM_H__
+
+/*
+ * INCLUDE FILES
+ *****************************************************************************************
+ */
+#include <stdint.h>
+
+/*
+ * DEFINES
+ *****************************************************************************************
+ */
+#ifndef USER_RAM_RETENTION_ENABLE
+#define USER_RAM_RETENTION_ENABLE           1       /**< Power down unretained RAM blocks in sleep (GCC builds). */
+#endif
+
+/*
+ * MACROS
+ *****************************************************************************************
+ */
+/**@brief Retention classes, put in front of a static variable.
+ *
+ * - USER_RAM_RETAIN:  kept across sleep, the default of plain .data/.bss (bond, CCCD, pointer state).
+ * - USER_RAM_SCRATCH: only valid while awake, content is undefined after every sleep and never zeroed.
+ * - USER_RAM_REINIT:  content is undefined after sleep, the owner drains it before sleep and re-inits
+ *                     it on wake (UART TX buffer, drained by the app_uart sleep check).
+ */
+#define USER_RAM_RETAIN
+#if defined(__ICCARM__)
+#define USER_RAM_SCRATCH                    _Pragma("location=\".user_scratch\"") __no_init
+#define USER_RAM_REINIT                     _Pragma("location=\".user_reinit\"") __no_init
+#else
+#define USER_RAM_SCRATCH                    __attribute__((section(".user_scratch")))
+#define USER_RAM_REINIT                     __attribute__((section(".user_reinit")))
+#endif
+
+/*
+ * GLOBAL FUNCTION DECLARATION
+ *****************************************************************************************
+ */
+/**
+ *****************************************************************************************
+ * @brief Register the sleep callbacks that limit RAM retention to the retained range.
+ *****************************************************************************************
+ */
+void user_ram_init(void);
+
+/**
+ *****************************************************************************************
+ * @brief Bytes of RAM kept powered in sleep, 0 when every block is retained.
+ *****************************************************************************************
+ */
+uint32_t user_ram_retained_size(void);
+
+#endif
@@ -0,0 +1,270 @@
+/**
+ *****************************************************************************************
+ *
+ * @file user_settings.c
+ *
+ * @brief Persistent settings implementation.
+ *
+ *****************************************************************************************
+ * @attention
+  #####Copyright (c) 2019 GOODIX
+  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of GOODIX nor the names of its contributors may be used
+    to endorse or promote products derived from this software without
+    specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************************
+ */
+/*
+ * INCLUDE FILES
+ *****************************************************************************************
+ */
+#include "user_settings.h"
+#include "user_gesture.h"
+#include "app_timer.h"
+#include "app_log.h"
+#include "app_error.h"
+
+/*
+ * STRUCT DEFINE
+ *****************************************************************************************
+ */
+/**@brief One registered record. */
+typedef struct
+{
+    NvdsTag_t   tag;
+    const void *p_data;
+    uint16_t    length;
+    uint16_t    crc;            /**< CRC of the content in NVDS, an unchanged record is not written again. */
+    bool        crc_valid;
+    bool        dirty;
+    bool        erase;
+} settings_record_t;
+
+/*
+ * LOCAL VARIABLE DEFINITIONS
+ *****************************************************************************************
+ */
+static settings_record_t  s_settings_record[USER_SETTINGS_RECORD_MAX];
+static uint8_t            s_settings_record_nb;
+static app_timer_id_t     s_settings_timer_id;
+static volatile bool      s_settings_pending;       /**< At least one record is dirty, the timer runs. */
+static volatile bool      s_settings_commit_due;
+static volatile uint32_t  s_settings_activity;
+static uint32_t           s_settings_activity_seen;
+static uint32_t           s_settings_since_commit_ms = USER_SETTINGS_MIN_PERIOD_MS;
+static uint32_t           s_settings_writes;        /**< NVDS writes and deletes since boot. */
+static uint32_t           s_settings_skipped;       /**< Dirty records left alone, content unchanged. */
+
+/*
+ * LOCAL FUNCTION DEFINITIONS
+ *****************************************************************************************
+ */
+static uint16_t settings_crc16(const uint8_t *p_data, uint16_t length)
+{
+    uint16_t crc = 0xFFFF;
+
+    while (length--)
+    {
+        crc ^= (uint16_t)(*p_data++) << 8;
+        for (uint8_t i = 0; i < 8; i++)
+        {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+static settings_record_t *settings_record_find(NvdsTag_t tag)
+{
+    for (uint8_t i = 0; i < s_settings_record_nb; i++)
+    {
+        if (s_settings_record[i].tag == tag)
+        {
+            return &s_settings_record[i];
+        }
+    }
+    return NULL;
+}
+
+static void settings_pending_set(void)
+{
+    if (!s_settings_pending)
+    {
+        s_settings_pending = true;
+        app_timer_start(s_settings_timer_id, USER_SETTINGS_IDLE_MS, NULL);
+    }
+}
+
+static bool settings_is_idle(void)
+{
+    return !user_gesture_is_busy() && s_settings_since_commit_ms >= USER_SETTINGS_MIN_PERIOD_MS;
+}
+
+static void settings_timer_handler(void *p_arg)
+{
+    if (s_settings_since_commit_ms < USER_SETTINGS_MIN_PERIOD_MS)
+    {
+        s_settings_since_commit_ms += USER_SETTINGS_IDLE_MS;
+    }
+    // A whole period without activity, the link is idle.
+    if (s_settings_activity != s_settings_activity_seen)
+    {
+        s_settings_activity_seen = s_settings_activity;
+        return;
+    }
+    if (settings_is_idle())
+    {
+        s_settings_commit_due = true;
+    }
+}
+
+/*
+ * GLOBAL FUNCTION DEFINITIONS
+ *****************************************************************************************
+ */
+void user_settings_init(void)
+{
+    sdk_err_t error_code;
+
+    error_code = app_timer_create(&s_settings_timer_id, ATIMER_REPEAT, settings_timer_handler);
+    APP_ERROR_CHECK(error_code);
+}
+
+void user_settings_register(NvdsTag_t tag, const void *p_data, uint16_t length)
+{
+    settings_record_t *p_rec = settings_record_find(tag);
+
+    if (NULL == p_rec)
+    {
+        if (s_settings_record_nb >= USER_SETTINGS_RECORD_MAX)
+        {
+            APP_LOG_ERROR("Settings 0x%04x not registered, raise USER_SETTINGS_RECORD_MAX.", tag);
+            return;
+        }
+        p_rec = &s_settings_record[s_settings_record_nb++];
+    }
+    p_rec->tag       = tag;
+    p_rec->p_data    = p_data;
+    p_rec->length    = length;
+    // The RAM copy was just loaded, it matches NVDS (or the default when there is no record).
+    p_rec->crc       = settings_crc16((const uint8_t *)p_data, length);
+    p_rec->crc_valid = true;
+}
+
+void user_settings_dirty(NvdsTag_t tag)
+{
+    settings_record_t *p_rec = settings_record_find(tag);
+
+    if (p_rec)
+    {
+        p_rec->dirty = true;
+        p_rec->erase = false;
+        settings_pending_set();
+    }
+}
+
+void user_settings_erase(NvdsTag_t tag)
+{
+    settings_record_t *p_rec = settings_record_find(tag);
+
+    if (p_rec)
+    {
+        p_rec->dirty = true;
+        p_rec->erase = true;
+        settings_pending_set();
+    }
+}
+
+void user_settings_activity(void)
+{
+    s_settings_activity++;
+}
+
+void user_settings_schedule(void)
+{
+    if (s_settings_commit_due)
+    {
+        s_settings_commit_due = false;
+        user_settings_commit();
+    }
+}
+
+void user_settings_commit(void)
+{
+    settings_record_t *p_rec;
+    uint16_t           crc;
+    uint8_t            err;
+    bool               retry = false;
+
+    app_timer_stop(s_settings_timer_id);
+    s_settings_pending         = false;
+    s_settings_commit_due      = false;
+    s_settings_since_commit_ms = 0;
+
+    for (uint8_t i = 0; i < s_settings_record_nb; i++)
+    {
+        p_rec = &s_settings_record[i];
+        if (!p_rec->dirty)
+        {
+            continue;
+        }
+
+        if (p_rec->erase)
+        {
+            err              = nvds_del(p_rec->tag);
+            p_rec->crc_valid = false;
+            s_settings_writes++;
+        }
+        else
+        {
+            crc = settings_crc16((const uint8_t *)p_rec->p_data, p_rec->length);
+            if (p_rec->crc_valid && crc == p_rec->crc)
+            {
+                p_rec->dirty = false;
+                s_settings_skipped++;
+                continue;
+            }
+            err = nvds_put(p_rec->tag, p_rec->length, (const uint8_t *)p_rec->p_data);
+            s_settings_writes++;
+            if (NVDS_SUCCESS == err)
+            {
+                p_rec->crc       = crc;
+                p_rec->crc_valid = true;
+            }
+        }
+        // A record never written has nothing to delete.
+        if (NVDS_SUCCESS != err && !(p_rec->erase && NVDS_TAG_NOT_EXISTED == err))
+        {
+            // Stays dirty, the next idle commit retries it.
+            APP_LOG_WARNING("Settings 0x%04x not saved (0x%x).", p_rec->tag, err);
+            retry = true;
+            continue;
+        }
+        p_rec->dirty = false;
+    }
+    if (retry)
+    {
+        settings_pending_set();
+    }
+    APP_LOG_DEBUG("Settings committed, %d writes, %d skipped since boot.", s_settings_writes, s_settings_skipped);
+}
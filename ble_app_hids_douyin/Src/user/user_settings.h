@@ -0,0 +1,112 @@
+/**
+ *****************************************************************************************
+ *
+ * @file user_settings.h
+ *
+ * @brief Persistent settings, RAM records written to NVDS in batches when the link is idle.
+ *
+ *****************************************************************************************
+ * @attention
+  #####Copyright (c) 2019 GOODIX
+  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of GOODIX nor the names of its contributors may be used
+    to endorse or promote products derived from this software without
+    specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************************
+ */
+#ifndef __USER_SETTINGS_H__
+#define __USER_SETTINGS_H__
+
+/*
+ * INCLUDE FILES
+ *****************************************************************************************
+ */
+#include "gr_includes.h"
+
+/*
+ * DEFINES
+ *****************************************************************************************
+ */
+#define USER_SETTINGS_RECORD_MAX        8       /**< Registered records. */
+#define USER_SETTINGS_IDLE_MS           500     /**< No BLE event nor gesture for this long before a commit. */
+#define USER_SETTINGS_MIN_PERIOD_MS     10000   /**< Least time between two commits, bounds the flash wear. */
+
+/*
+ * GLOBAL FUNCTION DECLARATION
+ *****************************************************************************************
+ */
+/**
+ *****************************************************************************************
+ * @brief Create the commit timer.
+ *****************************************************************************************
+ */
+void user_settings_init(void);
+
+/**
+ *****************************************************************************************
+ * @brief Register a RAM record backed by an NVDS tag. The caller loads it with nvds_get()
+ *        first, then only changes the RAM copy.
+ *
+ * @param[in] tag:    NVDS tag, NV_TAG_APP(x).
+ * @param[in] p_data: RAM copy, must stay valid.
+ * @param[in] length: Record length.
+ *****************************************************************************************
+ */
+void user_settings_register(NvdsTag_t tag, const void *p_data, uint16_t length);
+
+/**
+ *****************************************************************************************
+ * @brief The RAM copy of a record changed, write it with the next commit.
+ *****************************************************************************************
+ */
+void user_settings_dirty(NvdsTag_t tag);
+
+/**
+ *****************************************************************************************
+ * @brief Delete a record from NVDS with the next commit.
+ *****************************************************************************************
+ */
+void user_settings_erase(NvdsTag_t tag);
+
+/**
+ *****************************************************************************************
+ * @brief Note link or input activity, it postpones the commit. Safe from interrupts.
+ *****************************************************************************************
+ */
+void user_settings_activity(void);
+
+/**
+ *****************************************************************************************
+ * @brief Commit when due, call from the main loop.
+ *****************************************************************************************
+ */
+void user_settings_schedule(void);
+
+/**
+ *****************************************************************************************
+ * @brief Write every dirty record now, skipping the ones whose content did not change.
+ *****************************************************************************************
+ */
+void user_settings_commit(void);
+
+#endif
@@ -0,0 +1,241 @@
+/**
+ *****************************************************************************************
+ *
+ * @file user_stats.c
+ *
+ * @brief Runtime statistics for the Performance Statistics Service.
+ *
+ *****************************************************************************************
+ * @attention
+  #####Copyright (c) 2019 GOODIX
+  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of GOODIX nor the names of its contributors may be used
+    to endorse or promote products derived from this software without
+    specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************************
+ */
+/*
+ * INCLUDE FILES
+ *****************************************************************************************
+ */
+#include "user_stats.h"
+#include "user_perf.h"
+#include "stats.h"
+#include "app_timer.h"
+#include "app_log.h"
+#include "app_error.h"
+#include <string.h>
+
+/*
+ * DEFINES
+ *****************************************************************************************
+ */
+#define STATS_LATENCY_UNIT_US       100
+
+/*
+ * LOCAL VARIABLE DEFINITIONS
+ *****************************************************************************************
+ */
+static user_stats_data_t s_stats;               /**< Counters, latency is filled in by user_stats_get(). */
+static app_timer_id_t    s_stats_timer_id;
+static uint32_t          s_stats_uptime_ms;
+static uint32_t          s_stats_sleep_ms;
+static uint32_t          s_stats_awake_us;      /**< Awake time at the last tick. */
+static uint32_t          s_stats_ntf_queued;
+static uint8_t           s_stats_phy;           /**< Link state, kept across a reset. */
+static int8_t            s_stats_tx_power;
+
+/*
+ * LOCAL FUNCTION DEFINITIONS
+ *****************************************************************************************
+ */
+/**
+ *****************************************************************************************
+ * @brief Time not spent awake during a tick was spent asleep. Ticks are short enough
+ *        to fold the awake time base within one cycle counter wrap.
+ *****************************************************************************************
+ */
+static void stats_timer_handler(void *p_arg)
+{
+    uint32_t now      = user_perf_now_us();
+    uint32_t awake_ms = (now - s_stats_awake_us) / 1000;
+
+    s_stats_awake_us   = now;
+    s_stats_uptime_ms += USER_STATS_TICK_MS;
+    if (awake_ms < USER_STATS_TICK_MS)
+    {
+        s_stats_sleep_ms += USER_STATS_TICK_MS - awake_ms;
+    }
+}
+
+static uint16_t stats_latency_unit(uint32_t us)
+{
+    us /= STATS_LATENCY_UNIT_US;
+    return (us > UINT16_MAX) ? UINT16_MAX : us;
+}
+
+static uint16_t stats_data_get(uint8_t *p_buf, uint16_t max_len)
+{
+    user_stats_data_t data;
+    uint16_t          length = (sizeof(data) < max_len) ? sizeof(data) : max_len;
+
+    user_stats_get(&data);
+    memcpy(p_buf, &data, length);
+
+    return length;
+}
+
+static void stats_service_process_event(stats_evt_t *p_evt)
+{
+    switch (p_evt->evt_type)
+    {
+        case STATS_EVT_RESET:
+            APP_LOG_INFO("Statistics reset by peer.");
+            user_stats_reset();
+            break;
+
+        default:
+            break;
+    }
+}
+
+/*
+ * GLOBAL FUNCTION DEFINITIONS
+ *****************************************************************************************
+ */
+void user_stats_init(void)
+{
+    sdk_err_t    error_code;
+    stats_init_t stats_init;
+
+    stats_init.evt_handler = stats_service_process_event;
+    stats_init.data_get    = stats_data_get;
+    error_code = stats_service_init(&stats_init);
+    APP_ERROR_CHECK(error_code);
+
+    s_stats_awake_us = user_perf_now_us();
+    error_code = app_timer_create(&s_stats_timer_id, ATIMER_REPEAT, stats_timer_handler);
+    APP_ERROR_CHECK(error_code);
+    error_code = app_timer_start(s_stats_timer_id, USER_STATS_TICK_MS, NULL);
+    APP_ERROR_CHECK(error_code);
+}
+
+void user_stats_report_sent(void)
+{
+    s_stats.reports_sent++;
+    // Sent from the main loop, completed from the BLE event handler.
+    GLOBAL_EXCEPTION_DISABLE();
+    s_stats_ntf_queued++;
+    if (s_stats_ntf_queued > s_stats.ntf_queue_hwm)
+    {
+        s_stats.ntf_queue_hwm = (s_stats_ntf_queued > UINT8_MAX) ? UINT8_MAX : s_stats_ntf_queued;
+    }
+    GLOBAL_EXCEPTION_ENABLE();
+}
+
+void user_stats_report_failed(sdk_err_t err)
+{
+    s_stats.reports_failed++;
+    for (uint8_t i = 0; i < USER_STATS_ERR_SLOTS; i++)
+    {
+        if (s_stats.report_err[i].err == err || s_stats.report_err[i].count == 0)
+        {
+            s_stats.report_err[i].err = err;
+            if (s_stats.report_err[i].count < UINT16_MAX)
+            {
+                s_stats.report_err[i].count++;
+            }
+            return;
+        }
+    }
+}
+
+void user_stats_ntf_sent(void)
+{
+    if (s_stats_ntf_queued)
+    {
+        s_stats_ntf_queued--;
+    }
+}
+
+void user_stats_phy(uint8_t phy)
+{
+    s_stats_phy = phy;
+}
+
+void user_stats_tx_power(int8_t dbm)
+{
+    s_stats_tx_power = dbm;
+}
+
+void user_stats_key_queue(uint32_t depth, uint32_t dropped)
+{
+    if (depth > s_stats.key_queue_hwm)
+    {
+        s_stats.key_queue_hwm = (depth > UINT8_MAX) ? UINT8_MAX : depth;
+    }
+    s_stats.key_evt_dropped = ((s_stats.key_evt_dropped + dropped) > UINT16_MAX) ?
+                              UINT16_MAX : (s_stats.key_evt_dropped + dropped);
+}
+
+void user_stats_connected(void)
+{
+    s_stats.connections++;
+}
+
+void user_stats_disconnected(uint8_t reason)
+{
+    s_stats.disconnections++;
+    s_stats.last_disc_reason = reason;
+    // Notifications still queued are flushed with the link.
+    s_stats_ntf_queued = 0;
+}
+
+void user_stats_reset(void)
+{
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_stats_sleep_ms = 0;
+    user_latency_reset();
+    user_perf_profile_reset();
+}
+
+void user_stats_get(user_stats_data_t *p_data)
+{
+    latency_summary_t summary;
+
+    memcpy(p_data, &s_stats, sizeof(user_stats_data_t));
+    p_data->version  = USER_STATS_VERSION;
+    p_data->uptime_s = s_stats_uptime_ms / 1000;
+    p_data->sleep_s  = s_stats_sleep_ms / 1000;
+    p_data->phy      = s_stats_phy;
+    p_data->tx_power = s_stats_tx_power;
+    for (uint8_t span = 0; span < LATENCY_SPAN_NB; span++)
+    {
+        user_latency_summary_get((latency_span_t)span, &summary);
+        p_data->latency[span].count = (summary.count > UINT16_MAX) ? UINT16_MAX : summary.count;
+        p_data->latency[span].min   = stats_latency_unit(summary.min);
+        p_data->latency[span].avg   = stats_latency_unit(summary.avg);
+        p_data->latency[span].max   = stats_latency_unit(summary.max);
+        p_data->latency[span].p99   = stats_latency_unit(summary.p99);
+    }
+}
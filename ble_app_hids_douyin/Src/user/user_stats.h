@@ -0,0 +1,174 @@
+/**
+ *****************************************************************************************
+ *
+ * @file user_stats.h
+ *
+ * @brief Runtime statistics for the Performance Statistics Service.
+ *
+ *****************************************************************************************
+ * @attention
+  #####Copyright (c) 2019 GOODIX
+  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of GOODIX nor the names of its contributors may be used
+    to endorse or promote products derived from this software without
+    specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************************
+ */
+#ifndef __USER_STATS_H__
+#define __USER_STATS_H__
+
+/*
+ * INCLUDE FILES
+ *****************************************************************************************
+ */
+#include "gr_includes.h"
+#include "user_latency.h"
+
+/*
+ * DEFINES
+ *****************************************************************************************
+ */
+#define USER_STATS_VERSION          1           /**< Layout version of user_stats_data_t, first byte of the value. */
+#define USER_STATS_ERR_SLOTS        4           /**< Distinct report send errors counted one by one. */
+#define USER_STATS_TICK_MS          10000       /**< Uptime and sleep time resolution. */
+
+/*
+ * TYPEDEFS
+ *****************************************************************************************
+ */
+/**@brief Latency summary of one span, in 100 us units saturated at 0xFFFF. */
+typedef struct
+{
+    uint16_t count;
+    uint16_t min;
+    uint16_t avg;
+    uint16_t max;
+    uint16_t p99;
+} __attribute__((packed)) user_stats_latency_t;
+
+/**@brief Statistics Data value, little endian. */
+typedef struct
+{
+    uint8_t  version;                                   /**< USER_STATS_VERSION. */
+    uint8_t  last_disc_reason;                          /**< HCI reason of the last disconnection. */
+    uint16_t connections;
+    uint16_t disconnections;
+    uint16_t key_evt_dropped;                           /**< Key events lost because the key event ring was full. */
+    uint32_t uptime_s;                                  /**< Since boot, not cleared by a reset. */
+    uint32_t sleep_s;
+    uint32_t reports_sent;                              /**< Input reports queued to the stack. */
+    uint32_t reports_failed;                            /**< Input reports refused by the stack, all errors. */
+    struct
+    {
+        uint16_t err;                                   /**< sdk_err_t, 0 for an unused slot. */
+        uint16_t count;
+    } __attribute__((packed)) report_err[USER_STATS_ERR_SLOTS];
+    uint8_t  key_queue_hwm;                             /**< Most key events waiting for the main loop. */
+    uint8_t  ntf_queue_hwm;                             /**< Most notifications queued and not yet sent. */
+    uint8_t  phy;                                       /**< PHY in use, tx in bits 0-3 and rx in bits 4-7, 1 for 1M, 2 for 2M, 0 when not connected. */
+    int8_t   tx_power;                                  /**< Connection TX power in dBm, 0 when not connected. */
+    user_stats_latency_t latency[LATENCY_SPAN_NB];      /**< Indexed by latency_span_t. */
+} __attribute__((packed)) user_stats_data_t;
+
+/*
+ * GLOBAL FUNCTION DECLARATION
+ *****************************************************************************************
+ */
+/**
+ *****************************************************************************************
+ * @brief Add the Performance Statistics Service and start the uptime tick.
+ *****************************************************************************************
+ */
+void user_stats_init(void);
+
+/**
+ *****************************************************************************************
+ * @brief An input report was queued to the stack.
+ *****************************************************************************************
+ */
+void user_stats_report_sent(void);
+
+/**
+ *****************************************************************************************
+ * @brief An input report was refused by the stack.
+ *****************************************************************************************
+ */
+void user_stats_report_failed(sdk_err_t err);
+
+/**
+ *****************************************************************************************
+ * @brief A notification was sent on air.
+ *****************************************************************************************
+ */
+void user_stats_ntf_sent(void);
+
+/**
+ *****************************************************************************************
+ * @brief PHY in use, as returned by user_link_phy_get().
+ *****************************************************************************************
+ */
+void user_stats_phy(uint8_t phy);
+
+/**
+ *****************************************************************************************
+ * @brief Connection TX power in dBm.
+ *****************************************************************************************
+ */
+void user_stats_tx_power(int8_t dbm);
+
+/**
+ *****************************************************************************************
+ * @brief Key events found waiting by the main loop, and newly dropped ones.
+ *****************************************************************************************
+ */
+void user_stats_key_queue(uint32_t depth, uint32_t dropped);
+
+/**
+ *****************************************************************************************
+ * @brief Link connected.
+ *****************************************************************************************
+ */
+void user_stats_connected(void);
+
+/**
+ *****************************************************************************************
+ * @brief Link disconnected.
+ *****************************************************************************************
+ */
+void user_stats_disconnected(uint8_t reason);
+
+/**
+ *****************************************************************************************
+ * @brief Clear all counters, latency histograms and profile tables.
+ *****************************************************************************************
+ */
+void user_stats_reset(void);
+
+/**
+ *****************************************************************************************
+ * @brief Take a snapshot of the statistics.
+ *****************************************************************************************
+ */
+void user_stats_get(user_stats_data_t *p_data);
+
+#endif
@@ -0,0 +1,241 @@
+/**
+ *****************************************************************************************
+ *
+ * @file user_trace.c
+ *
+ * @brief Binary event trace ring implementation.
+ *
+ *****************************************************************************************
+ * @attention
+  #####Copyright (c) 2019 GOODIX
+  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of GOODIX nor the names of its contributors may be used
+    to endorse or promote products derived from this software without
+    specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************************
+ */
+/*
+ * INCLUDE FILES
+ *****************************************************************************************
+ */
+#include "user_trace.h"
+#include "user_perf.h"
+#include "app_log.h"
+#include "app_pwr_mgmt.h"
+#include "board_SK.h"
+#include "SEGGER_RTT.h"
+
+/*
+ * DEFINES
+ *****************************************************************************************
+ */
+#define TRACE_RING_MASK             (USER_TRACE_RING_SIZE - 1)
+
+#if (USER_TRACE_ENABLE && (USER_TRACE_PORT == USER_TRACE_PORT_UART) && (APP_LOG_PORT == 0))
+#error "The trace stream cannot share the UART with the log, use RTT or move the log."
+#endif
+
+#if USER_TRACE_ENABLE
+/*
+ * LOCAL VARIABLE DEFINITIONS
+ *****************************************************************************************
+ */
+static trace_record_t    s_trace_ring[USER_TRACE_RING_SIZE];
+static volatile uint32_t s_trace_head;              /**< Written under a critical section by user_trace_record(). */
+static volatile uint32_t s_trace_tail;              /**< Written by user_trace_flush() only. */
+static volatile uint32_t s_trace_dropped;
+static uint32_t          s_trace_dropped_sent;
+static uint32_t          s_trace_since_sync;        /**< Records streamed since the last sync record. */
+static uint32_t          s_trace_last_cycles;       /**< Timestamp of the last streamed record. */
+#if (USER_TRACE_PORT == USER_TRACE_PORT_RTT)
+static uint8_t           s_trace_rtt_buf[USER_TRACE_RTT_BUF_SIZE];
+#endif
+
+/*
+ * LOCAL FUNCTION DEFINITIONS
+ *****************************************************************************************
+ */
+/**
+ *****************************************************************************************
+ * @brief How many of nb records the port takes without blocking.
+ *****************************************************************************************
+ */
+static uint32_t trace_port_room(uint32_t nb)
+{
+#if (USER_TRACE_PORT == USER_TRACE_PORT_RTT)
+    uint32_t room = SEGGER_RTT_GetAvailWriteSpace(USER_TRACE_RTT_CHANNEL) / sizeof(trace_record_t);
+
+    return (nb < room) ? nb : room;
+#else
+    return nb;
+#endif
+}
+
+static void trace_port_write(const trace_record_t *p_rec, uint32_t nb)
+{
+#if (USER_TRACE_PORT == USER_TRACE_PORT_RTT)
+    SEGGER_RTT_Write(USER_TRACE_RTT_CHANNEL, p_rec, nb * sizeof(trace_record_t));
+#else
+    bsp_uart_send((uint8_t *)p_rec, nb * sizeof(trace_record_t));
+#endif
+}
+
+/**
+ *****************************************************************************************
+ * @brief Stream a record generated at flush time, if the port has room for it.
+ *****************************************************************************************
+ */
+static bool trace_port_write_one(uint8_t id, uint8_t arg8, uint16_t arg16, uint32_t cycles)
+{
+    trace_record_t rec;
+
+    if (trace_port_room(1) == 0)
+    {
+        return false;
+    }
+    rec.cycles = cycles;
+    rec.id     = id;
+    rec.arg8   = arg8;
+    rec.arg16  = arg16;
+    trace_port_write(&rec, 1);
+
+    return true;
+}
+
+static bool trace_sleep_enter(void)
+{
+    USER_TRACE(TRACE_ID_SLEEP_ENTER, 0, 0);
+
+    return true;
+}
+
+static void trace_sleep_canceled(void)
+{
+    USER_TRACE(TRACE_ID_SLEEP_EXIT, 1, 0);
+}
+
+/**
+ *****************************************************************************************
+ * @brief The cycle counter counts awake time only, so time spent asleep is not part of the trace.
+ *****************************************************************************************
+ */
+static void trace_wake_up(void)
+{
+    USER_TRACE(TRACE_ID_SLEEP_EXIT, 0, 0);
+}
+
+static const app_sleep_callbacks_t s_trace_sleep_cb =
+{
+    .app_prepare_for_sleep = trace_sleep_enter,
+    .app_sleep_canceled    = trace_sleep_canceled,
+    .app_wake_up_ind       = trace_wake_up,
+};
+#endif
+
+/*
+ * GLOBAL FUNCTION DEFINITIONS
+ *****************************************************************************************
+ */
+void user_trace_init(void)
+{
+#if USER_TRACE_ENABLE
+#if (USER_TRACE_PORT == USER_TRACE_PORT_RTT)
+    SEGGER_RTT_ConfigUpBuffer(USER_TRACE_RTT_CHANNEL, "Trace", s_trace_rtt_buf, sizeof(s_trace_rtt_buf),
+                              SEGGER_RTT_MODE_NO_BLOCK_SKIP);
+#else
+    bsp_uart_init();
+#endif
+    pwr_register_sleep_cb(&s_trace_sleep_cb, WAPEUP_PRIORITY_LOW);
+#endif
+}
+
+void user_trace_record(uint8_t id, uint8_t arg8, uint16_t arg16)
+{
+#if USER_TRACE_ENABLE
+    trace_record_t *p_rec;
+
+    GLOBAL_EXCEPTION_DISABLE();
+    if ((s_trace_head - s_trace_tail) >= USER_TRACE_RING_SIZE)
+    {
+        s_trace_dropped++;
+    }
+    else
+    {
+        // Stamped inside the critical section, so records are in time order.
+        p_rec         = &s_trace_ring[s_trace_head & TRACE_RING_MASK];
+        p_rec->cycles = USER_PERF_CYCLES();
+        p_rec->id     = id;
+        p_rec->arg8   = arg8;
+        p_rec->arg16  = arg16;
+        s_trace_head++;
+    }
+    GLOBAL_EXCEPTION_ENABLE();
+#endif
+}
+
+void user_trace_flush(void)
+{
+#if USER_TRACE_ENABLE
+    uint32_t tail = s_trace_tail;
+    uint32_t nb;
+    uint32_t contiguous;
+
+    if (s_trace_dropped != s_trace_dropped_sent)
+    {
+        nb = s_trace_dropped - s_trace_dropped_sent;
+        if (!trace_port_write_one(TRACE_ID_DROP, 0, (nb > UINT16_MAX) ? UINT16_MAX : nb, s_trace_last_cycles))
+        {
+            return;
+        }
+        s_trace_dropped_sent = s_trace_dropped;
+    }
+
+    while (tail != s_trace_head)
+    {
+        if (s_trace_since_sync == 0)
+        {
+            if (!trace_port_write_one(TRACE_ID_SYNC, SystemCoreClock / 1000000, USER_TRACE_SYNC_MAGIC,
+                                      s_trace_ring[tail & TRACE_RING_MASK].cycles))
+            {
+                break;
+            }
+        }
+
+        nb         = s_trace_head - tail;
+        contiguous = USER_TRACE_RING_SIZE - (tail & TRACE_RING_MASK);
+        nb         = (nb < contiguous) ? nb : contiguous;
+        nb         = (nb < (USER_TRACE_SYNC_EVERY - s_trace_since_sync)) ? nb : (USER_TRACE_SYNC_EVERY - s_trace_since_sync);
+        nb         = trace_port_room(nb);
+        if (nb == 0)
+        {
+            break;
+        }
+        trace_port_write(&s_trace_ring[tail & TRACE_RING_MASK], nb);
+
+        s_trace_last_cycles = s_trace_ring[(tail + nb - 1) & TRACE_RING_MASK].cycles;
+        s_trace_since_sync  = (s_trace_since_sync + nb) % USER_TRACE_SYNC_EVERY;
+        tail               += nb;
+        s_trace_tail        = tail;
+    }
+#endif
+}
@@ -0,0 +1,132 @@
+/**
+ *****************************************************************************************
+ *
+ * @file user_trace.h
+ *
+ * @brief Binary event trace ring API.
+ *
+ *****************************************************************************************
+ * @attention
+  #####Copyright (c) 2019 GOODIX
+  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of GOODIX nor the names of its contributors may be used
+    to endorse or promote products derived from this software without
+    specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************************
+ */
+#ifndef __USER_TRACE_H__
+#define __USER_TRACE_H__
+
+/*
+ * INCLUDE FILES
+ *****************************************************************************************
+ */
+#include "gr_includes.h"
+
+/*
+ * DEFINES
+ *****************************************************************************************
+ */
+#ifndef USER_TRACE_ENABLE
+#define USER_TRACE_ENABLE           1           /**< Record trace events, 0 compiles every trace point out. */
+#endif
+
+#define USER_TRACE_PORT_RTT         0           /**< Stream on SEGGER RTT up channel 1, beside the log on channel 0. */
+#define USER_TRACE_PORT_UART        1           /**< Stream on the board UART, only when the log does not use it. */
+
+#ifndef USER_TRACE_PORT
+#define USER_TRACE_PORT             USER_TRACE_PORT_RTT
+#endif
+
+#define USER_TRACE_RING_SIZE        128         /**< Records buffered between two flushes, must be a power of 2. */
+#define USER_TRACE_RTT_CHANNEL      1
+#define USER_TRACE_RTT_BUF_SIZE     1024
+#define USER_TRACE_SYNC_EVERY       64          /**< A sync record is streamed before every this many records. */
+#define USER_TRACE_SYNC_MAGIC       0x7A3C      /**< arg16 of a sync record, lets the host find record boundaries. */
+
+/*
+ * MACROS
+ *****************************************************************************************
+ */
+#if USER_TRACE_ENABLE
+#define USER_TRACE(id, arg8, arg16)         user_trace_record((id), (arg8), (arg16))
+#else
+#define USER_TRACE(id, arg8, arg16)
+#endif
+
+/*
+ * TYPEDEFS
+ *****************************************************************************************
+ */
+/**@brief Trace event IDs, keep in sync with tools/trace_to_chrome.py. */
+typedef enum
+{
+    TRACE_ID_KEY_IRQ = 1,       /**< arg8: key ID, arg16: user_evt_type_t. */
+    TRACE_ID_GESTURE_BEGIN,     /**< arg8: gesture_type_t. */
+    TRACE_ID_GESTURE_END,       /**< arg8: gesture_type_t, arg16: delay to the next step in ms, 0 when done. */
+    TRACE_ID_REPORT_BEGIN,      /**< hids_input_rep_send() entry, arg8: report index, arg16: connection index. */
+    TRACE_ID_REPORT_END,        /**< hids_input_rep_send() exit, arg8: report index, arg16: sdk_err_t. */
+    TRACE_ID_NTF_DONE,          /**< arg8: connection index, arg16: attribute handle. */
+    TRACE_ID_BLE_EVT,           /**< arg8: low byte of evt_status, arg16: evt_id. */
+    TRACE_ID_SLEEP_ENTER,
+    TRACE_ID_SLEEP_EXIT,        /**< arg8: 1 if the sleep was canceled. */
+    TRACE_ID_CLOCK,             /**< arg8: new core clock in MHz, arg16: transition time in us. */
+    TRACE_ID_DROP   = 0xFE,     /**< arg16: records dropped because the ring was full. */
+    TRACE_ID_SYNC   = 0xFF,     /**< arg8: core clock in MHz, arg16: USER_TRACE_SYNC_MAGIC. */
+} trace_id_t;
+
+/**@brief One trace record, streamed as is (8 bytes, little endian). */
+typedef struct
+{
+    uint32_t cycles;            /**< USER_PERF_CYCLES() when recorded. */
+    uint8_t  id;
+    uint8_t  arg8;
+    uint16_t arg16;
+} trace_record_t;
+
+/*
+ * GLOBAL FUNCTION DECLARATION
+ *****************************************************************************************
+ */
+/**
+ *****************************************************************************************
+ * @brief Set up the stream port and the sleep enter/exit trace points.
+ *****************************************************************************************
+ */
+void user_trace_init(void);
+
+/**
+ *****************************************************************************************
+ * @brief Record one event, callable from interrupt context. Use USER_TRACE() instead.
+ *****************************************************************************************
+ */
+void user_trace_record(uint8_t id, uint8_t arg8, uint16_t arg16);
+
+/**
+ *****************************************************************************************
+ * @brief Stream buffered records, called from the main loop.
+ *****************************************************************************************
+ */
+void user_trace_flush(void);
+
+#endif
@@ -0,0 +1,127 @@
+/**
+ *****************************************************************************************
+ *
+ * @file user_trajectory.c
+ *
+ * @brief Velocity profiled touch trajectory generator implementation.
+ *
+ *****************************************************************************************
+ * @attention
+  #####Copyright (c) 2019 GOODIX
+  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of GOODIX nor the names of its contributors may be used
+    to endorse or promote products derived from this software without
+    specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************************
+ */
+/*
+ * INCLUDE FILES
+ *****************************************************************************************
+ */
+#include "user_trajectory.h"
+
+/*
+ * GLOBAL FUNCTION DEFINITIONS
+ *****************************************************************************************
+ */
+void trajectory_init(trajectory_t *p_traj, int32_t start, int32_t end, uint32_t exit_speed, uint32_t frame_period_ms)
+{
+    uint32_t distance   = (end >= start) ? (uint32_t)(end - start) : (uint32_t)(start - end);
+    uint32_t exit_step  = exit_speed * frame_period_ms / 1000;
+    uint32_t accel_dist = 0;
+    uint32_t fling_dist;
+    uint32_t fling_frames;
+
+    if (exit_step == 0)
+    {
+        exit_step = 1;
+    }
+
+    // Ramp at exit_step/4, exit_step/2 ... only when the fling part can still keep its minimum frames.
+    for (uint8_t i = 0; i < TRAJECTORY_ACCEL_FRAMES; i++)
+    {
+        accel_dist += exit_step >> (TRAJECTORY_ACCEL_FRAMES - i);
+    }
+    if (distance >= accel_dist + TRAJECTORY_EXIT_FRAMES_MIN * exit_step)
+    {
+        p_traj->accel_frames = TRAJECTORY_ACCEL_FRAMES;
+    }
+    else
+    {
+        p_traj->accel_frames = 0;
+        accel_dist           = 0;
+    }
+
+    // Floor division keeps every fling step at or above exit_step.
+    fling_dist   = distance - accel_dist;
+    fling_frames = fling_dist / exit_step;
+    if (fling_frames < TRAJECTORY_EXIT_FRAMES_MIN)
+    {
+        fling_frames = TRAJECTORY_EXIT_FRAMES_MIN;
+    }
+    if (fling_frames > fling_dist)
+    {
+        fling_frames = fling_dist ? fling_dist : 1;
+    }
+    if (fling_frames > UINT8_MAX - TRAJECTORY_ACCEL_FRAMES)
+    {
+        fling_frames = UINT8_MAX - TRAJECTORY_ACCEL_FRAMES;
+    }
+
+    p_traj->pos         = start;
+    p_traj->dir         = (end >= start) ? 1 : -1;
+    p_traj->exit_step   = exit_step;
+    p_traj->fling_step  = fling_dist / fling_frames;
+    p_traj->fling_rem   = fling_dist % fling_frames;
+    p_traj->frame_count = p_traj->accel_frames + fling_frames;
+    p_traj->frame       = 0;
+}
+
+bool trajectory_next(trajectory_t *p_traj, int32_t *p_pos)
+{
+    uint32_t step;
+
+    if (p_traj->frame >= p_traj->frame_count)
+    {
+        return false;
+    }
+
+    if (p_traj->frame < p_traj->accel_frames)
+    {
+        step = p_traj->exit_step >> (p_traj->accel_frames - p_traj->frame);
+    }
+    else
+    {
+        // Leftover units go to the last frames, so the velocity never drops right before lift.
+        uint8_t fling_idx    = p_traj->frame - p_traj->accel_frames;
+        uint8_t fling_frames = p_traj->frame_count - p_traj->accel_frames;
+
+        step = p_traj->fling_step + ((fling_idx >= fling_frames - p_traj->fling_rem) ? 1 : 0);
+    }
+
+    p_traj->pos += p_traj->dir * (int32_t)step;
+    p_traj->frame++;
+    *p_pos = p_traj->pos;
+
+    return true;
+}
@@ -0,0 +1,105 @@
+/**
+ *****************************************************************************************
+ *
+ * @file user_trajectory.h
+ *
+ * @brief Velocity profiled touch trajectory generator API.
+ *
+ *****************************************************************************************
+ * @attention
+  #####Copyright (c) 2019 GOODIX
+  All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+  * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+  * Neither the name of GOODIX nor the names of its contributors may be used
+    to endorse or promote products derived from this software without
+    specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDERS AND CONTRIBUTORS BE
+  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************************
+ */
+#ifndef __USER_TRAJECTORY_H__
+#define __USER_TRAJECTORY_H__
+
+/*
+ * INCLUDE FILES
+ *****************************************************************************************
+ */
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * DEFINES
+ *****************************************************************************************
+ */
+#define TRAJECTORY_ACCEL_FRAMES         2       /**< Accelerate frames before the fling, at 1/4 and 1/2 of the exit step. */
+#define TRAJECTORY_EXIT_FRAMES_MIN      2       /**< Minimum frames at exit velocity, the host needs two samples to measure it. */
+
+/*
+ * TYPEDEFS
+ *****************************************************************************************
+ */
+/**@brief Trajectory of one axis, positions are in report logical units. */
+typedef struct
+{
+    int32_t  pos;               /**< Position of the last emitted frame. */
+    int32_t  dir;               /**< +1 or -1. */
+    uint32_t exit_step;         /**< Step per frame at exit velocity. */
+    uint32_t fling_step;        /**< Base step of the fling frames, not less than exit_step when distance allows. */
+    uint32_t fling_rem;         /**< Leftover distance spread one unit per fling frame. */
+    uint8_t  accel_frames;      /**< Frames of the accelerate phase. */
+    uint8_t  frame_count;       /**< Total move frames. */
+    uint8_t  frame;             /**< Frames emitted so far. */
+} trajectory_t;
+
+/*
+ * GLOBAL FUNCTION DECLARATION
+ *****************************************************************************************
+ */
+/**
+ *****************************************************************************************
+ * @brief Plan an accelerate-then-fling trajectory.
+ *
+ * @details The trajectory emits the fewest frames whose last steps still reach the exit
+ *          velocity: TRAJECTORY_ACCEL_FRAMES ramp frames, then at least
+ *          TRAJECTORY_EXIT_FRAMES_MIN frames at or above the exit step. The last frame
+ *          lands exactly on the end position.
+ *
+ * @param[out] p_traj:          Trajectory to plan.
+ * @param[in]  start:           Start position, where the contact goes down.
+ * @param[in]  end:             End position, where the contact lifts.
+ * @param[in]  exit_speed:      Exit velocity in logical units per second.
+ * @param[in]  frame_period_ms: Time between two frames, in ms.
+ *****************************************************************************************
+ */
+void trajectory_init(trajectory_t *p_traj, int32_t start, int32_t end, uint32_t exit_speed, uint32_t frame_period_ms);
+
+/**
+ *****************************************************************************************
+ * @brief Get the position of the next frame.
+ *
+ * @param[in,out] p_traj: Trajectory planned by trajectory_init().
+ * @param[out]    p_pos:  Position of the next frame.
+ *
+ * @return true if a frame is emitted, false once the end position has been reached.
+ *****************************************************************************************
+ */
+bool trajectory_next(trajectory_t *p_traj, int32_t *p_pos);
+
+#endif
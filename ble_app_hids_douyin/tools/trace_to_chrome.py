@@ -0,0 +1,140 @@
+#!/usr/bin/env python3
+"""Convert the binary trace stream of user_trace.c to Chrome trace / Perfetto JSON.
+
+Capture the stream with J-Link (RTT up channel 1):
+    JLinkRTTLogger -Device GR5332CENE -If SWD -Speed 4000 -RTTChannel 1 trace.bin
+or from the UART when USER_TRACE_PORT is USER_TRACE_PORT_UART, then:
+    python3 trace_to_chrome.py trace.bin -o trace.json
+and open trace.json in chrome://tracing or https://ui.perfetto.dev.
+
+Records are 8 bytes little endian: uint32 cycles, uint8 id, uint8 arg8, uint16 arg16.
+Cycle counts wrap every 2^32 cycles, gaps longer than that without any record
+cannot be recovered. Time spent asleep is not part of the timeline. Clock
+records switch the cycle to time scale, see user_clock.c.
+"""
+import argparse
+import json
+import struct
+import sys
+
+RECORD = struct.Struct('<IBBH')
+SYNC_MAGIC = 0x7A3C
+
+# trace_id_t in user_trace.h
+KEY_IRQ, GESTURE_BEGIN, GESTURE_END, REPORT_BEGIN, REPORT_END, NTF_DONE, BLE_EVT, SLEEP_ENTER, SLEEP_EXIT, CLOCK = range(1, 11)
+DROP = 0xFE
+SYNC = 0xFF
+KNOWN_IDS = set(range(1, 11)) | {DROP, SYNC}
+
+GESTURES = ['none', 'up', 'down', 'left', 'right', 'double', 'func', 'camera', 'pinch_in', 'pinch_out']
+KEY_EVTS = ['down', 'up', 'click']
+REPORTS = ['keyboard', 'finger', 'mouse', 'mouse_xy']
+
+TRACKS = {'keys': 1, 'gesture': 2, 'hids': 3, 'ble': 4, 'power': 5}
+
+
+def name_of(table, idx):
+    return table[idx] if idx < len(table) else str(idx)
+
+
+def is_sync(data, pos):
+    if pos + RECORD.size > len(data):
+        return False
+    _, rid, _, arg16 = RECORD.unpack_from(data, pos)
+    return rid == SYNC and arg16 == SYNC_MAGIC
+
+
+def records(data):
+    """Yield (cycles, id, arg8, arg16), resynchronizing on corrupt or lost bytes."""
+    pos = 0
+    synced = False
+    while pos + RECORD.size <= len(data):
+        if not synced:
+            if not is_sync(data, pos):
+                pos += 1
+                continue
+            synced = True
+        rec = RECORD.unpack_from(data, pos)
+        if rec[1] not in KNOWN_IDS:
+            synced = False
+            pos += 1
+            continue
+        yield rec
+        pos += RECORD.size
+
+
+def convert(data, default_mhz):
+    events = [{'ph': 'M', 'pid': 1, 'name': 'process_name', 'args': {'name': 'ble_app_hids_douyin'}}]
+    for track, tid in TRACKS.items():
+        events.append({'ph': 'M', 'pid': 1, 'tid': tid, 'name': 'thread_name', 'args': {'name': track}})
+
+    mhz = default_mhz
+    last = None
+    now = 0.0
+    for cycles, rid, arg8, arg16 in records(data):
+        if last is not None:
+            now += ((cycles - last) & 0xFFFFFFFF) / mhz
+        last = cycles
+
+        def emit(ph, track, name, **args):
+            ev = {'ph': ph, 'pid': 1, 'tid': TRACKS[track], 'ts': round(now, 3), 'name': name}
+            if ph == 'i':
+                ev['s'] = 't'
+            if args:
+                ev['args'] = args
+            events.append(ev)
+
+        if rid == SYNC:
+            mhz = arg8 or mhz
+        elif rid == DROP:
+            emit('i', 'keys', 'dropped', records=arg16)
+            events[-1]['s'] = 'g'
+        elif rid == KEY_IRQ:
+            emit('i', 'keys', 'key %d %s' % (arg8, name_of(KEY_EVTS, arg16)))
+        elif rid == GESTURE_BEGIN:
+            emit('B', 'gesture', name_of(GESTURES, arg8))
+        elif rid == GESTURE_END:
+            emit('E', 'gesture', name_of(GESTURES, arg8), next_ms=arg16)
+        elif rid == REPORT_BEGIN:
+            emit('B', 'hids', name_of(REPORTS, arg8), conn=arg16)
+        elif rid == REPORT_END:
+            emit('E', 'hids', name_of(REPORTS, arg8), err=arg16 - 0x10000 if arg16 & 0x8000 else arg16)
+        elif rid == NTF_DONE:
+            emit('i', 'ble', 'ntf done', conn=arg8, handle=arg16)
+        elif rid == BLE_EVT:
+            emit('i', 'ble', 'evt 0x%04x' % arg16, status=arg8)
+        elif rid == SLEEP_ENTER:
+            emit('B', 'power', 'sleep')
+        elif rid == SLEEP_EXIT:
+            emit('E', 'power', 'sleep', canceled=bool(arg8))
+        elif rid == CLOCK:
+            # Cycles after this record count at the new clock.
+            mhz = arg8 or mhz
+            emit('i', 'power', 'clock %d MHz' % arg8, switch_us=arg16)
+
+    return {'traceEvents': events, 'displayTimeUnit': 'ns'}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('input', help="binary trace stream, '-' for stdin")
+    parser.add_argument('-o', '--output', default='-', help="JSON output, '-' for stdout")
+    parser.add_argument('--mhz', type=int, default=64, help='core clock until the first sync record')
+    args = parser.parse_args()
+
+    if args.input == '-':
+        data = sys.stdin.buffer.read()
+    else:
+        with open(args.input, 'rb') as f:
+            data = f.read()
+
+    trace = convert(data, args.mhz)
+    if args.output == '-':
+        json.dump(trace, sys.stdout)
+    else:
+        with open(args.output, 'w') as f:
+            json.dump(trace, f)
+
+
+if __name__ == '__main__':
+    main()